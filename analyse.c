@@ -0,0 +1,244 @@
+/*
+LightsOff:
+A clone of the Tim Horton's LightsOff program written in C, adding variable
+board sizes, undo and clear movements and a solver.
+
+Copyright 2016-2021, Javier Burguete Tolosa.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file analyse.c
+ * \brief Source file of the lights off board sizes analyser.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2016-2021, Javier Burguete Tolosa.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <glib.h>
+#include "config.h"
+#include "game.h"
+
+///> Struct to define the analysis of a board size.
+typedef struct
+{
+  uint64_t *null;
+  ///< Basis of the movements combinations not changing the game status
+  ///< (null space dimension x words number).
+  unsigned int nrows;           ///< Rows number.
+  unsigned int ncolumns;        ///< Columns number.
+  unsigned int nwords;          ///< Words number of a board.
+  unsigned int nnull;           ///< Null space dimension.
+} AnalyseSize;
+
+///> Struct to define the data shared by the analysis threads.
+typedef struct
+{
+  AnalyseSize *size;            ///< Array of board sizes.
+  GMutex mutex;                 ///< Mutex to take the board sizes.
+  unsigned int nsizes;          ///< Number of board sizes not taken.
+  unsigned int stencil;         ///< Neighbourhood of the movements.
+} AnalyseData;
+
+/**
+ * Function to analyse board sizes in a thread. The sizes are taken from the
+ * last (the largest) to balance the load.
+ *
+ * \return NULL.
+ */
+static gpointer
+analyse_thread (AnalyseData * data)     ///< analysis data.
+{
+  Solver *solver;
+  AnalyseSize *size;
+  unsigned int i, j;
+  solver = (Solver *) g_malloc (sizeof (Solver));
+  for (;;)
+    {
+      // Taking a board size
+      g_mutex_lock (&data->mutex);
+      if (!data->nsizes)
+        {
+          g_mutex_unlock (&data->mutex);
+          break;
+        }
+      size = data->size + --data->nsizes;
+      g_mutex_unlock (&data->mutex);
+
+      // Computing the null space of the movements matrix
+      solver_init_stencil (solver, size->nrows, size->ncolumns,
+                           data->stencil);
+      size->nwords = solver->nwords;
+      size->nnull = solver->nnull;
+      size->null = (uint64_t *)
+        g_malloc (MAX (1, solver->nnull * solver->nwords) * sizeof (uint64_t));
+      for (i = 0; i < solver->nnull; ++i)
+        if (solver->nwords == 1)
+          size->null[i] = solver->null_array[i];
+        else
+          for (j = 0; j < solver->nwords; ++j)
+            size->null[i * solver->nwords + j] = solver->null_board[i].word[j];
+    }
+  g_free (solver);
+  return NULL;
+}
+
+/**
+ * Function to write the analysis of a board size as a JSON object.
+ */
+static void
+size_write (FILE * file,        ///< output file.
+            const AnalyseSize * size)   ///< analysis of the board size.
+{
+  double fraction;
+  unsigned int i, nsquares;
+  nsquares = size->nrows * size->ncolumns;
+  for (i = 0, fraction = 1.; i < size->nnull; ++i)
+    fraction *= 0.5;
+  fprintf (file, "{\"rows\":%u,\"columns\":%u,\"squares\":%u,\"rank\":%u,"
+           "\"null_dimension\":%u,\"solvable_fraction\":%.17g,"
+           "\"null_basis\":[", size->nrows, size->ncolumns, nsquares,
+           nsquares - size->nnull, size->nnull, fraction);
+  for (i = 0; i < size->nnull; ++i)
+    {
+      if (i)
+        fputc (',', file);
+      fputc ('"', file);
+      board_write (file, size->null + i * size->nwords, size->nwords);
+      fputc ('"', file);
+    }
+  fputs ("]}", file);
+}
+
+/**
+ * Main function.
+ *
+ * \return 0 on succes, error code on error.
+ */
+int
+main (int argn,                 ///< arguments number.
+      char **argc)              ///< array of argument chains.
+{
+  AnalyseData data;
+  AnalyseSize *size;
+  FILE *file;
+  const char *name;
+  unsigned int i, nthreads, nrows, ncolumns, nsizes, max_rows, max_columns;
+  int stencil;
+
+  // Reading the command line
+  nthreads = 0;
+  name = "plus";
+  max_rows = N_MAX_ROWS;
+  max_columns = N_MAX_COLUMNS;
+  for (; argn > 2; argn -= 2, argc += 2)
+    if (!strcmp (argc[1], "-t"))
+      nthreads = atoi (argc[2]);
+    else if (!strcmp (argc[1], "-n"))
+      name = argc[2];
+    else if (!strcmp (argc[1], "-m") && argn > 3)
+      {
+        // Option with two arguments
+        max_rows = atoi (argc[2]);
+        max_columns = atoi (argc[3]);
+        --argn;
+        ++argc;
+      }
+    else
+      break;
+  if (argn > 2)
+    {
+      fprintf (stderr, "Usage: lightsoff-analyse [-t threads] "
+               "[-n neighbourhood] [-m max_rows max_columns] "
+               "[output_file]\n");
+      return 1;
+    }
+  stencil = solver_stencil (name);
+  if (stencil < 0)
+    {
+      fprintf (stderr, "lightsoff-analyse: bad neighbourhood (plus, x, "
+               "square or knight, optionally followed by -torus)\n");
+      return 1;
+    }
+  if (max_rows < 2 || max_rows > N_MAX_ROWS || max_columns < 2
+      || max_columns > N_MAX_COLUMNS)
+    {
+      fprintf (stderr, "lightsoff-analyse: bad board size (2x2 to %ux%u)\n",
+               N_MAX_ROWS, N_MAX_COLUMNS);
+      return 1;
+    }
+  if (argn == 2)
+    {
+      file = fopen (argc[1], "w");
+      if (!file)
+        {
+          fprintf (stderr, "lightsoff-analyse: unable to open %s\n",
+                   argc[1]);
+          return 1;
+        }
+    }
+  else
+    file = stdout;
+
+  // Analysing every board size in parallel
+  nsizes = (max_rows - 1) * (max_columns - 1);
+  size = (AnalyseSize *) g_malloc (nsizes * sizeof (AnalyseSize));
+  for (nrows = 2, i = 0; nrows <= max_rows; ++nrows)
+    for (ncolumns = 2; ncolumns <= max_columns; ++ncolumns, ++i)
+      {
+        size[i].nrows = nrows;
+        size[i].ncolumns = ncolumns;
+      }
+  data.size = size;
+  data.nsizes = nsizes;
+  data.stencil = stencil;
+  g_mutex_init (&data.mutex);
+  if (!nthreads)
+    nthreads = g_get_num_processors ();
+  nthreads = MAX (1, MIN (nthreads, nsizes));
+  GThread *thread[nthreads];
+  for (i = 1; i < nthreads; ++i)
+    thread[i] = g_thread_new (NULL, (GThreadFunc) analyse_thread, &data);
+  analyse_thread (&data);
+  for (i = 1; i < nthreads; ++i)
+    g_thread_join (thread[i]);
+  g_mutex_clear (&data.mutex);
+
+  // Writing the report
+  fprintf (file, "{\"neighbourhood\":\"%s\",\"sizes\":[", name);
+  for (i = 0; i < nsizes; ++i)
+    {
+      fputs (i ? ",\n" : "\n", file);
+      size_write (file, size + i);
+      g_free (size[i].null);
+    }
+  fputs ("\n]}\n", file);
+
+  // Closing
+  g_free (size);
+  if (file != stdout)
+    fclose (file);
+  return 0;
+}
@@ -0,0 +1,215 @@
+/*
+LightsOff:
+A clone of the Tim Horton's LightsOff program written in C, adding variable
+board sizes, undo and clear movements and a solver.
+
+Copyright 2016-2021, Javier Burguete Tolosa.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file bench.c
+ * \brief Source file of the lights off solver benchmark.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2016-2021, Javier Burguete Tolosa.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <glib.h>
+#include "config.h"
+#include "game.h"
+
+///> Maximum number of rows of the default benchmark.
+#define BENCH_MAX_ROWS 8
+///> Maximum number of columns of the default benchmark.
+#define BENCH_MAX_COLUMNS 8
+
+/**
+ * Function to get the time in nanoseconds.
+ *
+ * \return monotonic time in nanoseconds.
+ */
+static inline uint64_t
+bench_time ()
+{
+  struct timespec t;
+  clock_gettime (CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000000000L + t.tv_nsec;
+}
+
+/**
+ * Function to compare two latencies.
+ *
+ * \return -1 if the first is lower, 1 if it is greater, 0 if they are equal.
+ */
+static int
+bench_compare (const void *a,   ///< first latency.
+               const void *b)   ///< second latency.
+{
+  uint64_t x, y;
+  x = *(const uint64_t *) a;
+  y = *(const uint64_t *) b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * Function to benchmark the solver on a board size.
+ */
+static void
+bench_size (LightsOffGame * game,       ///< game.
+            unsigned long int seed,     ///< seed of the corpus.
+            unsigned int level, ///< game level.
+            unsigned int nboards,       ///< number of boards of the corpus.
+            unsigned int nrows, ///< rows number.
+            unsigned int ncolumns)      ///< columns number.
+{
+  Board *corpus;
+  GameRand rand;
+  uint64_t *latency, *boards, t0, t;
+  int *results;
+  unsigned long int nodes;
+  unsigned int i, nwords, nunsolvable;
+
+  // Initing the game without the optimal solutions table of the user cache
+  // directory, so the solver search is benchmarked whatever the machine state
+  game_init (game, nrows, ncolumns);
+  solver_table_close (&game->table);
+
+  // Generating the corpus by the game_new logic with a fixed seed
+  game->level = MIN (level, game->solver.nsquares);
+  nwords = game->solver.nwords;
+  corpus = (Board *) g_malloc (nboards * sizeof (Board));
+  boards = (uint64_t *) g_malloc (nboards * nwords * sizeof (uint64_t));
+  latency = (uint64_t *) g_malloc (nboards * sizeof (uint64_t));
+  results = (int *) g_malloc (nboards * sizeof (int));
+  game_rand_seed (&rand, seed);
+  for (i = 0; i < nboards; ++i)
+    {
+      game_new_rand (game, &rand);
+      corpus[i] = game->status;
+      memcpy (boards + i * nwords, corpus[i].word, nwords * sizeof (uint64_t));
+    }
+
+  // Throughput of play ()
+  t0 = bench_time ();
+  for (i = 0; i < nboards; ++i)
+    {
+      game->status = corpus[i];
+      play (game);
+    }
+  t = bench_time () - t0;
+
+  // Latency of every play () and explored nodes: combinations of the null
+  // space checked on every solvable board (counted by the instrumentation
+  // counters if the program is built with STATS)
+  for (i = nodes = nunsolvable = 0; i < nboards; ++i)
+    {
+      game->status = corpus[i];
+      t0 = bench_time ();
+      play (game);
+      latency[i] = bench_time () - t0;
+      if (game->nmovements < 0)
+        ++nunsolvable;
+      else
+#if STATS
+        nodes += game->stats.nodes;
+#else
+        nodes += 1L << game->solver.nnull;
+#endif
+    }
+  qsort (latency, nboards, sizeof (uint64_t), bench_compare);
+
+  // Throughput of play_batch ()
+  t0 = bench_time ();
+  play_batch (&game->solver, boards, nboards, results, NULL, NULL, 1);
+  t0 = bench_time () - t0;
+
+  printf ("%2ux%-2u %8u %12.0f %8lu %8lu %10.1f %8u %12.0f\n",
+          nrows, ncolumns, nboards, 1e9 * nboards / MAX (t, 1),
+          latency[nboards / 2], latency[nboards * 99 / 100],
+          (double) nodes / MAX (nboards - nunsolvable, 1), nunsolvable,
+          1e9 * nboards / MAX (t0, 1));
+
+  g_free (results);
+  g_free (latency);
+  g_free (boards);
+  g_free (corpus);
+}
+
+/**
+ * Main function.
+ *
+ * \return 0 on succes, error code on error.
+ */
+int
+main (int argn,                 ///< arguments number.
+      char **argc)              ///< array of argument chains.
+{
+  LightsOffGame *game;
+  unsigned long int seed;
+  unsigned int nrows, ncolumns, level, nboards;
+
+  // Reading the command line
+  if (argn != 4 && argn != 6)
+    {
+      fprintf (stderr, "Usage: lightsoff-bench seed level boards "
+               "[rows columns]\n");
+      return 1;
+    }
+  seed = strtoul (argc[1], NULL, 0);
+  level = atoi (argc[2]);
+  nboards = atoi (argc[3]);
+  if (!level || !nboards)
+    {
+      fprintf (stderr, "lightsoff-bench: bad level or boards number\n");
+      return 1;
+    }
+
+  // Benchmarking
+  game = (LightsOffGame *) g_malloc0 (sizeof (LightsOffGame));
+  printf ("# seed=%lu level=%u\n", seed, level);
+  printf ("# size   boards     solves/s  p50(ns)  p99(ns) nodes/solve "
+          "unsolved batch/s\n");
+  if (argn == 6)
+    {
+      nrows = atoi (argc[4]);
+      ncolumns = atoi (argc[5]);
+      if (nrows < 2 || nrows > N_MAX_ROWS || ncolumns < 2
+          || ncolumns > N_MAX_COLUMNS)
+        {
+          fprintf (stderr, "lightsoff-bench: bad board size (2x2 to %ux%u)\n",
+                   N_MAX_ROWS, N_MAX_COLUMNS);
+          return 1;
+        }
+      bench_size (game, seed, level, nboards, nrows, ncolumns);
+    }
+  else
+    for (nrows = 2; nrows <= BENCH_MAX_ROWS; ++nrows)
+      for (ncolumns = 2; ncolumns <= BENCH_MAX_COLUMNS; ++ncolumns)
+        bench_size (game, seed, level, nboards, nrows, ncolumns);
+  g_free (game);
+  return 0;
+}
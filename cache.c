@@ -0,0 +1,141 @@
+/*
+LightsOff:
+A clone of the Tim Horton's LightsOff program written in C, adding variable
+board sizes, undo and clear movements and a solver.
+
+Copyright 2016-2021, Javier Burguete Tolosa.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file cache.c
+ * \brief Source file of the lights off on-disk cache.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2016-2021, Javier Burguete Tolosa.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include "config.h"
+#include "cache.h"
+
+/**
+ * Function to build the name of the cache file of a board size.
+ *
+ * \return name of the file (freed with g_free).
+ */
+char *
+cache_name (const char *directory,
+            ///< cache directory (NULL to use the user cache directory).
+            const char *name,   ///< name of the data.
+            unsigned int nrows, ///< rows number.
+            unsigned int ncolumns)      ///< columns number.
+{
+  char *file, *buffer;
+  buffer = g_strdup_printf ("%s-%ux%u.cache", name, nrows, ncolumns);
+  if (directory)
+    file = g_build_filename (directory, buffer, NULL);
+  else
+    file = g_build_filename (g_get_user_cache_dir (), "lightsoff", buffer,
+                             NULL);
+  g_free (buffer);
+  return file;
+}
+
+/**
+ * Function to map a cache file read-only. The pages are shared by all the
+ * processes mapping the file.
+ *
+ * \return pointer to the data on succes, NULL if the file does not exist or
+ * it is not valid.
+ */
+const void *
+cache_open (const char *file,   ///< name of the cache file.
+            uint32_t version,   ///< version of the data format.
+            unsigned int nrows, ///< rows number.
+            unsigned int ncolumns,      ///< columns number.
+            uint64_t size,      ///< size of the data in bytes.
+            GMappedFile ** mapped)
+            ///< mapped file (freed with g_mapped_file_unref).
+{
+  const CacheHeader *header;
+  *mapped = g_mapped_file_new (file, FALSE, NULL);
+  if (!*mapped)
+    return NULL;
+
+  // Checking the header
+  header = (const CacheHeader *) g_mapped_file_get_contents (*mapped);
+  if (g_mapped_file_get_length (*mapped) != sizeof (CacheHeader) + size
+      || header->magic != CACHE_MAGIC || header->version != version
+      || header->nrows != nrows || header->ncolumns != ncolumns
+      || header->size != size)
+    {
+      g_mapped_file_unref (*mapped);
+      *mapped = NULL;
+      return NULL;
+    }
+  return header + 1;
+}
+
+/**
+ * Function to save a cache file. The file is written to a temporary file and
+ * renamed, so other processes never map a partial file.
+ *
+ * \return 1 on succes, 0 on error.
+ */
+int
+cache_save (const char *file,   ///< name of the cache file.
+            uint32_t version,   ///< version of the data format.
+            unsigned int nrows, ///< rows number.
+            unsigned int ncolumns,      ///< columns number.
+            const void *data,   ///< data.
+            uint64_t size)      ///< size of the data in bytes.
+{
+  CacheHeader *header;
+  char *directory;
+  int ok;
+
+  // Creating the directory
+  directory = g_path_get_dirname (file);
+  ok = !g_mkdir_with_parents (directory, 0755);
+  g_free (directory);
+  if (!ok)
+    return 0;
+
+  // Saving the header and the data
+  header = (CacheHeader *) g_malloc (sizeof (CacheHeader) + size);
+  memset (header, 0, sizeof (CacheHeader));
+  header->magic = CACHE_MAGIC;
+  header->version = version;
+  header->nrows = nrows;
+  header->ncolumns = ncolumns;
+  header->size = size;
+  memcpy (header + 1, data, size);
+  ok = g_file_set_contents (file, (const char *) header,
+                            sizeof (CacheHeader) + size, NULL);
+  g_free (header);
+  return ok;
+}
@@ -0,0 +1,59 @@
+/*
+LightsOff:
+A clone of the Tim Horton's LightsOff program written in C, adding variable
+board sizes, undo and clear movements and a solver.
+
+Copyright 2016-2021, Javier Burguete Tolosa.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file cache.h
+ * \brief Header file of the lights off on-disk cache.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2016-2021, Javier Burguete Tolosa.
+ */
+#ifndef CACHE__H
+#define CACHE__H 1
+
+#define CACHE_MAGIC 0x434F534CU ///< Magic number of the cache files ("LSOC").
+
+///> Struct to define the header of a cache file. The data follow the header.
+typedef struct
+{
+  uint32_t magic;               ///< Magic number.
+  uint32_t version;             ///< Version of the data format.
+  uint32_t nrows;               ///< Rows number.
+  uint32_t ncolumns;            ///< Columns number.
+  uint64_t size;                ///< Size of the data in bytes.
+} __attribute__ ((aligned (64))) CacheHeader;
+
+char *cache_name (const char *directory, const char *name,
+                  unsigned int nrows, unsigned int ncolumns);
+const void *cache_open (const char *file, uint32_t version,
+                        unsigned int nrows, unsigned int ncolumns,
+                        uint64_t size, GMappedFile ** mapped);
+int cache_save (const char *file, uint32_t version, unsigned int nrows,
+                unsigned int ncolumns, const void *data, uint64_t size);
+
+#endif
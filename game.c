@@ -37,268 +37,1722 @@ OF SUCH DAMAGE.
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <inttypes.h>
+#include <time.h>
 #include <glib.h>
 #include "config.h"
+#include "cache.h"
 #include "game.h"
 
-unsigned int nrows;             ///< Rows number.
-unsigned int ncolumns;          ///< Columns number.
-unsigned int nsquares;          ///< Squares number.
-unsigned int level = DEFAULT_LEVEL;     ///< Game level.
+///> Version of the solver data saved in the cache files (to increase on every
+///> change of the Solver struct).
+#define SOLVER_VERSION 4
+///> Version of the optimal solutions tables saved in the cache files.
+#define TABLE_VERSION 2
+///> Number of words of the solver basis saved before the optimal solutions
+///> tables (solution array of N_TABLE_SQUARES words and null space basis).
+#define TABLE_BASIS 32
+///> Number of boards taken at once by a batch thread.
+#define BATCH_CHUNK 256
+///> Number of words of the bitsliced vectors.
+#define SLICE_WIDTH 4
+///> Number of boards solved at once by the bitsliced kernel.
+#define SLICE_BOARDS (64 * SLICE_WIDTH)
+///> Number of one word solvers specialized on the null space dimension.
+#define N_PLAY_WORD 7
 
-uint64_t status;                ///< Current game status.
-int nmovements;                 ///< Movements number of the optimal solution.
-///> Array of movements of the optimal solution.
-unsigned int movement[N_MAX_SQUARES];
-///> Array of possible movements codified in bit chains.
-uint64_t movements_array[N_MAX_SQUARES];
+#if STATS
+///> Macro to add to an instrumentation counter if the counters are saved.
+#define STATS_ADD(stats, counter, n) \
+  do { if (stats) (stats)->counter += (n); } while (0)
+#else
+///> Macro to add to an instrumentation counter (disabled).
+#define STATS_ADD(stats, counter, n) do {} while (0)
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SLICE_AVX2 1            ///< Macro to enable the AVX2 bitsliced kernel.
+#else
+#define SLICE_AVX2 0            ///< Macro to enable the AVX2 bitsliced kernel.
+#endif
+
+///> Type of the bitsliced vectors.
+typedef uint64_t SliceVector
+  __attribute__ ((vector_size (SLICE_WIDTH * sizeof (uint64_t))));
+
+///> Struct to define the range of boards of a batch thread.
+typedef struct
+{
+  GMutex mutex;                 ///< Mutex to access to the range.
+  unsigned int begin;           ///< Index of the first board to solve.
+  unsigned int end;             ///< Index of the last board to solve + 1.
+} __attribute__ ((aligned (64))) BatchRange;
+
+///> Struct to define the data of a batch thread.
+typedef struct
+{
+  const Solver *solver;         ///< Solver data.
+  const uint64_t *boards;       ///< Array of packed boards.
+  int *results;                 ///< Array of movements numbers.
+  uint64_t *solutions;          ///< Array of packed optimal movements.
+  SolverStats *stats;           ///< Array of instrumentation counters.
+  BatchRange *range;            ///< Array of boards ranges of the threads.
+  unsigned int nthreads;        ///< Number of threads.
+  unsigned int thread;          ///< Thread number.
+} BatchThread;
+
+///> Number of squares switched by a movement of every neighbourhood.
+static const unsigned int stencil_size[N_STENCILS] = { 5, 5, 9, 9 };
+
+///> Array of (row, column) offsets of the squares switched by a movement of
+///> every neighbourhood.
+static const int stencil_offset[N_STENCILS][9][2] = {
+  {{0, 0}, {0, 1}, {0, -1}, {1, 0}, {-1, 0}},
+  {{0, 0}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}},
+  {{0, 0}, {0, 1}, {0, -1}, {1, 0}, {-1, 0}, {1, 1}, {1, -1}, {-1, 1},
+   {-1, -1}},
+  {{0, 0}, {1, 2}, {1, -2}, {-1, 2}, {-1, -2}, {2, 1}, {2, -1}, {-2, 1},
+   {-2, -1}},
+};
+
+///> Array of names of the neighbourhoods.
+static const char *stencil_name[N_STENCILS] = {
+  "plus", "x", "square", "knight"
+};
 
 /**
- * Function to generate the array of movements.
+ * Function to write a packed board codified as a hexadecimal bits chain.
+ */
+void
+board_write (FILE * file,       ///< output file.
+             const uint64_t * board,    ///< packed board.
+             unsigned int nwords)       ///< number of words.
+{
+  int i;
+  for (i = nwords - 1; i > 0 && !board[i]; --i);
+  fprintf (file, "%" PRIx64, board[i]);
+  while (--i >= 0)
+    fprintf (file, "%016" PRIx64, board[i]);
+}
+
+/**
+ * Function to get a neighbourhood from its name: "plus", "x", "square" or
+ * "knight", optionally followed by "-torus" to wrap around the board edges.
+ *
+ * \return neighbourhood on succes, -1 on error.
+ */
+int
+solver_stencil (const char *name)       ///< name of the neighbourhood.
+{
+  size_t length;
+  unsigned int i;
+  for (i = 0; i < N_STENCILS; ++i)
+    {
+      length = strlen (stencil_name[i]);
+      if (strncmp (name, stencil_name[i], length))
+        continue;
+      if (!name[length])
+        return i;
+      if (!strcmp (name + length, "-torus"))
+        return i | SOLVER_STENCIL_TORUS;
+    }
+  return -1;
+}
+
+/**
+ * Function to generate the array of movements switching the squares of the
+ * neighbourhood stencil.
  */
 static inline void
-generate_movements ()
+generate_movements (Solver * solver)    ///< solver data.
 {
-  unsigned int i, j, top, left, centre, right, bottom;
+  Board *m;
+  const int (*offset)[2];
+  int i, j, k, l, nrows, ncolumns;
+  unsigned int n, stencil, torus;
+
+  nrows = (int) solver->nrows;
+  ncolumns = (int) solver->ncolumns;
+  stencil = solver->stencil & ~SOLVER_STENCIL_TORUS;
+  torus = solver->stencil & SOLVER_STENCIL_TORUS;
+  offset = stencil_offset[stencil];
+  for (i = 0; i < nrows; ++i)
+    for (j = 0; j < ncolumns; ++j)
+      {
+        m = solver->movements_board + i * ncolumns + j;
+        board_zero (m, solver->nwords);
+        for (n = 0; n < stencil_size[stencil]; ++n)
+          {
+            k = i + offset[n][0];
+            l = j + offset[n][1];
+            if (torus)
+              {
+                k = (k % nrows + nrows) % nrows;
+                l = (l % ncolumns + ncolumns) % ncolumns;
+              }
+            else if (k < 0 || k >= nrows || l < 0 || l >= ncolumns)
+              continue;
 
-  // left top corner
-  centre = 0;
-  right = 1;
-  bottom = ncolumns;
-  movements_array[centre] = (1L << centre) | (1L << right) | (1L << bottom);
+            // Setting the square (wrapped offsets can fall on the same
+            // square on small boards)
+            k = k * ncolumns + l;
+            m->word[k / N_WORD_SQUARES] |= 1L << (k % N_WORD_SQUARES);
+          }
+      }
 
-  // centre top squares
-  while (++centre < ncolumns - 1)
+  // One word movements
+  if (solver->nwords == 1)
+    for (n = 0; n < solver->nsquares; ++n)
+      solver->movements_array[n] = solver->movements_board[n].word[0];
+}
+
+/**
+ * Function to solve a linear system in GF(2) by Gaussian elimination.
+ */
+static void
+solve_system (Solver * solver,  ///< solver data.
+              unsigned int n,   ///< number of equations and unknowns.
+              uint64_t * row,
+///< array of equations: row i codifies the unknowns switching the term i.
+              uint64_t * solution,
+///< array of unknowns combinations switching every single term.
+              uint64_t * null,  ///< basis of the null space (n vectors).
+              uint64_t * parity)
+///< array of terms masks with even parity on every solvable system (n masks).
+{
+  uint64_t combination[N_WORD_SQUARES], r;
+  unsigned int pivot[N_WORD_SQUARES];
+  unsigned int i, j, k, rank;
+
+  // Combination i codifies the terms combined in the row i
+  for (i = 0; i < n; ++i)
+    combination[i] = 1L << i;
+
+  // Reducing the matrix
+  for (j = rank = 0; j < n; ++j)
     {
-      right = centre + 1;
-      left = centre - 1;
-      bottom = centre + ncolumns;
-      movements_array[centre] = (1L << centre) | (1L << right) | (1L << left)
-        | (1L << bottom);
+      for (i = rank; i < n && !(row[i] & (1L << j)); ++i);
+      if (i == n)
+        continue;
+      r = row[i], row[i] = row[rank], row[rank] = r;
+      r = combination[i], combination[i] = combination[rank],
+        combination[rank] = r;
+      for (i = 0; i < n; ++i)
+        if (i != rank && (row[i] & (1L << j)))
+          {
+            row[i] ^= row[rank];
+            combination[i] ^= combination[rank];
+          }
+      pivot[rank++] = j;
     }
 
-  // right top corner
-  left = centre - 1;
-  bottom = centre + ncolumns;
-  movements_array[centre] = (1L << centre) | (1L << left) | (1L << bottom);
+  // Unknowns switching every single term
+  for (i = 0; i < n; ++i)
+    for (solution[i] = 0L, k = 0; k < rank; ++k)
+      if (combination[k] & (1L << i))
+        solution[i] |= 1L << pivot[k];
 
-  // centre rows
-  for (i = 1; i < nrows - 1; ++i)
+  // Null space basis from the free unknowns
+  for (j = k = solver->nnull = 0; j < n; ++j)
     {
+      if (k < rank && pivot[k] == j)
+        {
+          ++k;
+          continue;
+        }
+      for (r = 1L << j, i = 0; i < rank; ++i)
+        if (row[i] & (1L << j))
+          r |= 1L << pivot[i];
+      null[solver->nnull++] = r;
+    }
+
+  // Parity masks from the null rows
+  for (solver->nparity = 0, i = rank; i < n; ++i)
+    parity[solver->nparity++] = combination[i];
+}
 
-      // left centre squares
-      centre = i * ncolumns;
-      right = centre + 1;
-      bottom = centre + ncolumns;
-      top = centre - ncolumns;
-      movements_array[centre] =
-        (1L << centre) | (1L << right) | (1L << bottom) | (1L << top);
+/**
+ * Function to reduce the movements matrix generating the solution, null space
+ * and parity arrays.
+ */
+static inline void
+generate_solutions (Solver * solver)    ///< solver data.
+{
+  uint64_t row[N_WORD_SQUARES];
+  unsigned int i, j, n;
+
+  // Row i codifies the movements switching the light i
+  n = solver->nsquares;
+  for (i = 0; i < n; ++i)
+    for (row[i] = 0L, j = 0; j < n; ++j)
+      if (solver->movements_array[j] & (1L << i))
+        row[i] |= 1L << j;
 
-      // centre centre squares
-      for (j = 1; j < ncolumns - 1; ++j)
+  solve_system (solver, n, row, solver->solution_array, solver->null_array,
+                solver->parity_array);
+
+  // Transposed solution array
+  for (i = 0; i < n; ++i)
+    for (solver->slice_array[i] = 0L, j = 0; j < n; ++j)
+      if (solver->solution_array[j] & (1L << i))
+        solver->slice_array[i] |= 1L << j;
+}
+
+/**
+ * Function to solve a linear system in GF(2) by Gaussian elimination on
+ * multi-word boards.
+ */
+static void
+solve_system_board (Solver * solver,    ///< solver data.
+                    unsigned int n,     ///< number of equations and unknowns.
+                    Board * row,
+///< array of equations: row i codifies the unknowns switching the term i.
+                    Board * solution,
+///< array of unknowns combinations switching every single term.
+                    Board * null,
+///< basis of the null space (n vectors).
+                    Board * parity)
+///< array of terms masks with even parity on every solvable system (n masks).
+{
+  Board *combination, r;
+  unsigned int *pivot;
+  unsigned int i, j, k, rank, nwords;
+
+  // Combination i codifies the terms combined in the row i
+  nwords = solver->nwords;
+  combination = (Board *) g_malloc (n * sizeof (Board));
+  pivot = (unsigned int *) g_malloc (n * sizeof (unsigned int));
+  for (i = 0; i < n; ++i)
+    {
+      board_zero (combination + i, nwords);
+      board_set (combination + i, i);
+    }
+
+  // Reducing the matrix
+  for (j = rank = 0; j < n; ++j)
+    {
+      for (i = rank; i < n && !board_get (row + i, j); ++i);
+      if (i == n)
+        continue;
+      r = row[i], row[i] = row[rank], row[rank] = r;
+      r = combination[i], combination[i] = combination[rank],
+        combination[rank] = r;
+      for (i = 0; i < n; ++i)
+        if (i != rank && board_get (row + i, j))
+          {
+            board_xor (row + i, row + rank, nwords);
+            board_xor (combination + i, combination + rank, nwords);
+          }
+      pivot[rank++] = j;
+    }
+
+  // Unknowns switching every single term
+  for (i = 0; i < n; ++i)
+    for (board_zero (solution + i, nwords), k = 0; k < rank; ++k)
+      if (board_get (combination + k, i))
+        board_set (solution + i, pivot[k]);
+
+  // Null space basis from the free unknowns
+  for (j = k = solver->nnull = 0; j < n; ++j)
+    {
+      if (k < rank && pivot[k] == j)
         {
-          ++centre;
-          right = centre + 1;
-          left = centre - 1;
-          bottom = centre + ncolumns;
-          top = centre - ncolumns;
-          movements_array[centre] = (1L << centre) | (1L << right)
-            | (1L << left) | (1L << bottom) | (1L << top);
+          ++k;
+          continue;
         }
+      board_zero (&r, nwords);
+      board_set (&r, j);
+      for (i = 0; i < rank; ++i)
+        if (board_get (row + i, j))
+          board_set (&r, pivot[i]);
+      null[solver->nnull++] = r;
+    }
+
+  // Parity masks from the null rows
+  for (solver->nparity = 0, i = rank; i < n; ++i)
+    parity[solver->nparity++] = combination[i];
+  g_free (pivot);
+  g_free (combination);
+}
+
+/**
+ * Function to reduce the movements matrix of a multi-word board generating the
+ * solution, null space and parity boards (any neighbourhood).
+ */
+static inline void
+generate_solutions_board (Solver * solver)      ///< solver data.
+{
+  Board *row;
+  unsigned int i, j, n;
+
+  // Row i codifies the movements switching the light i
+  n = solver->nsquares;
+  row = (Board *) g_malloc (n * sizeof (Board));
+  for (i = 0; i < n; ++i)
+    board_zero (row + i, solver->nwords);
+  for (j = 0; j < n; ++j)
+    for (i = board_next (solver->movements_board + j, solver->nwords, -1);
+         (int) i >= 0;
+         i = board_next (solver->movements_board + j, solver->nwords, i))
+      board_set (row + i, j);
+
+  solve_system_board (solver, n, row, solver->solution_board,
+                      solver->null_board, solver->parity_board);
+  g_free (row);
+}
+
+/**
+ * Function to get a row of a board.
+ *
+ * \return bits chain codifying the row lights.
+ */
+static inline uint64_t
+board_get_row (const Solver * solver,   ///< solver data.
+               const Board * board,     ///< board.
+               unsigned int row)        ///< row index.
+{
+  uint64_t r;
+  unsigned int i, j;
+  i = row * solver->ncolumns;
+  j = i % N_WORD_SQUARES;
+  i /= N_WORD_SQUARES;
+  r = board->word[i] >> j;
+  if (j + solver->ncolumns > N_WORD_SQUARES)
+    r |= board->word[i + 1] << (N_WORD_SQUARES - j);
+  return r & solver->row_mask;
+}
+
+/**
+ * Function to switch lights of a row of a board.
+ */
+static inline void
+board_xor_row (const Solver * solver,   ///< solver data.
+               Board * board,   ///< board.
+               unsigned int row,        ///< row index.
+               uint64_t r)      ///< bits chain codifying the row lights.
+{
+  unsigned int i, j;
+  i = row * solver->ncolumns;
+  j = i % N_WORD_SQUARES;
+  i /= N_WORD_SQUARES;
+  board->word[i] ^= r << j;
+  if (j + solver->ncolumns > N_WORD_SQUARES)
+    board->word[i + 1] ^= r >> (N_WORD_SQUARES - j);
+}
 
-      // right centre squares
-      ++centre;
-      left = centre - 1;
-      bottom = centre + ncolumns;
-      top = centre - ncolumns;
-      movements_array[centre] = (1L << centre) | (1L << left) | (1L << bottom)
-        | (1L << top);
+/**
+ * Function to chase the lights to the bottom row: every light is switched off
+ * by a movement on the square below.
+ *
+ * \return bits chain codifying the bottom row lights left.
+ */
+static uint64_t
+chase (const Solver * solver,   ///< solver data.
+       const Board * status,    ///< board codifying the game status.
+       uint64_t top,            ///< top row movements.
+       Board * movements)       ///< board codifying the movements done.
+{
+  uint64_t previous, current, next, mask;
+  unsigned int i;
+  mask = solver->row_mask;
+  board_zero (movements, solver->nwords);
+  board_xor_row (solver, movements, 0, top);
+  previous = 0L;
+  current = top;
+  for (i = 0; i < solver->nrows - 1; ++i)
+    {
+      next = board_get_row (solver, status, i) ^ previous
+        ^ ((current ^ (current << 1) ^ (current >> 1)) & mask);
+      board_xor_row (solver, movements, i + 1, next);
+      previous = current;
+      current = next;
     }
+  return board_get_row (solver, status, i) ^ previous
+    ^ ((current ^ (current << 1) ^ (current >> 1)) & mask);
+}
 
-  // left bottom corner
-  centre = i * ncolumns;
-  right = centre + 1;
-  top = centre - ncolumns;
-  movements_array[centre] = (1L << centre) | (1L << right) | (1L << top);
+/**
+ * Function to generate the chase arrays: the bottom row lights left by
+ * chasing are a linear function of the top row movements, reduced here to
+ * solve the multi-word boards.
+ */
+static inline void
+generate_chases (Solver * solver)       ///< solver data.
+{
+  Board zero, light, movements;
+  uint64_t row[N_MAX_COLUMNS], null[N_MAX_COLUMNS], r;
+  unsigned int i, j, n;
+
+  // Chasing every top row movement
+  n = solver->ncolumns;
+  board_zero (&zero, solver->nwords);
+  for (j = 0; j < n; ++j)
+    solver->chase_array[j] = chase (solver, &zero, 1L << j,
+                                    solver->chase_board + j);
+
+  // Row i codifies the top row movements switching the bottom row light i
+  for (i = 0; i < n; ++i)
+    for (row[i] = 0L, j = 0; j < n; ++j)
+      if (solver->chase_array[j] & (1L << i))
+        row[i] |= 1L << j;
 
-  // centre bottom squares
-  for (j = 1; j < ncolumns - 1; ++j)
+  solve_system (solver, n, row, solver->chase_solution, null,
+                solver->chase_parity);
+
+  // Parity masks of the lights: the bottom row lights left by chasing are a
+  // linear function of the lights
+  for (i = 0; i < solver->nparity; ++i)
+    board_zero (solver->parity_board + i, solver->nwords);
+  for (j = 0; j < solver->nsquares; ++j)
     {
-      ++centre;
-      right = centre + 1;
-      left = centre - 1;
-      top = centre - ncolumns;
-      movements_array[centre] = (1L << centre) | (1L << right) | (1L << left)
-        | (1L << top);
+      board_zero (&light, solver->nwords);
+      board_set (&light, j);
+      r = chase (solver, &light, 0L, &movements);
+      for (i = 0; i < solver->nparity; ++i)
+        if (__builtin_parityll (r & solver->chase_parity[i]))
+          board_set (solver->parity_board + i, j);
     }
 
-  // right bottom corner
-  ++centre;
-  left = centre - 1;
-  top = centre - ncolumns;
-  movements_array[centre] = (1L << centre) | (1L << left) | (1L << top);
+  // Null space basis
+  for (i = 0; i < solver->nnull; ++i)
+    for (board_zero (solver->null_board + i, solver->nwords), r = null[i]; r;
+         r &= r - 1)
+      board_xor (solver->null_board + i,
+                 solver->chase_board + __builtin_ctzll (r), solver->nwords);
 }
 
 /**
- * Function to init a new game.
+ * Function to init the solver data of a board size and a neighbourhood. The
+ * lights of the multi-word boards are chased on the plus neighbourhood and
+ * solved by a general Gaussian elimination on the other neighbourhoods.
  */
 void
-game_init ()
+solver_init_stencil (Solver * solver,   ///< solver data.
+                     unsigned int nrows,        ///< rows number.
+                     unsigned int ncolumns,     ///< columns number.
+                     unsigned int stencil)      ///< neighbourhood.
+{
+  solver->nrows = nrows;
+  solver->ncolumns = ncolumns;
+  solver->nsquares = nrows * ncolumns;
+  solver->nwords = (solver->nsquares + N_WORD_SQUARES - 1) / N_WORD_SQUARES;
+  solver->row_mask = (1L << ncolumns) - 1L;
+  solver->stencil = stencil;
+  generate_movements (solver);
+  if (solver->nwords == 1)
+    {
+      generate_solutions (solver);
+      solver->kernel = MIN (solver->nnull, N_PLAY_WORD);
+    }
+  else if (stencil == SOLVER_STENCIL_PLUS)
+    generate_chases (solver);
+  else
+    generate_solutions_board (solver);
+}
+
+/**
+ * Function to init the solver data of a board size.
+ */
+void
+solver_init (Solver * solver,   ///< solver data.
+             unsigned int nrows,        ///< rows number.
+             unsigned int ncolumns)     ///< columns number.
+{
+  solver_init_stencil (solver, nrows, ncolumns, SOLVER_STENCIL_PLUS);
+}
+
+/**
+ * Function to build the name of the cache file of a board size and a
+ * neighbourhood.
+ *
+ * \return name of the file (freed with g_free).
+ */
+static char *
+solver_cache_name (const char *directory,
+                   ///< cache directory (NULL to use the user cache directory).
+                   const char *name,    ///< name of the data.
+                   unsigned int nrows,  ///< rows number.
+                   unsigned int ncolumns,       ///< columns number.
+                   unsigned int stencil)        ///< neighbourhood.
 {
+  char *file, *buffer;
+  if (stencil == SOLVER_STENCIL_PLUS)
+    return cache_name (directory, name, nrows, ncolumns);
+  buffer = g_strdup_printf ("%s-%s%s", name,
+                            stencil_name[stencil & ~SOLVER_STENCIL_TORUS],
+                            (stencil & SOLVER_STENCIL_TORUS) ? "-torus" : "");
+  file = cache_name (directory, buffer, nrows, ncolumns);
+  g_free (buffer);
+  return file;
+}
+
+/**
+ * Function to check the solver data mapped from a cache file, as the sizes
+ * bound the arrays loops and the kernel indexes the one word solvers.
+ *
+ * \return 1 on valid data, 0 on corrupt data.
+ */
+static int
+solver_is_valid (const Solver * solver, ///< solver data.
+                 unsigned int nrows,    ///< rows number.
+                 unsigned int ncolumns, ///< columns number.
+                 unsigned int stencil)  ///< neighbourhood.
+{
+  unsigned int nsquares, nmax;
   nsquares = nrows * ncolumns;
-  generate_movements ();
-  status = 0L;
+  nmax = (nsquares > N_WORD_SQUARES && stencil == SOLVER_STENCIL_PLUS)
+    ? ncolumns : nsquares;
+  return solver->nrows == nrows && solver->ncolumns == ncolumns
+    && solver->nsquares == nsquares
+    && solver->nwords == (nsquares + N_WORD_SQUARES - 1) / N_WORD_SQUARES
+    && solver->nwords <= N_MAX_WORDS && solver->stencil == stencil
+    && (stencil & ~SOLVER_STENCIL_TORUS) < N_STENCILS
+    && solver->nnull <= nmax && solver->nparity <= nmax
+    && (solver->nwords > 1
+        || solver->kernel == MIN (solver->nnull, N_PLAY_WORD));
+}
+
+/**
+ * Function to open the solver data of a board size mapping the cache file,
+ * or generating and saving them in the cache file if it does not exist or it
+ * is not valid.
+ *
+ * \return solver data (closed with solver_close).
+ */
+const Solver *
+solver_open (const char *directory,
+             ///< cache directory (NULL to use the user cache directory).
+             unsigned int nrows,        ///< rows number.
+             unsigned int ncolumns,     ///< columns number.
+             unsigned int stencil,      ///< neighbourhood.
+             GMappedFile ** mapped)
+             ///< mapped cache file (NULL if the data are not mapped).
+{
+  Solver *solver;
+  const Solver *cached;
+  char *file;
+
+  // Mapping the cache file
+  file = solver_cache_name (directory, "solver", nrows, ncolumns, stencil);
+  cached = (const Solver *)
+    cache_open (file, SOLVER_VERSION, nrows, ncolumns, sizeof (Solver),
+                mapped);
+  if (cached && !solver_is_valid (cached, nrows, ncolumns, stencil))
+    {
+      // Discarding corrupt data
+      solver_close (cached, *mapped);
+      *mapped = NULL;
+      cached = NULL;
+    }
+  if (!cached)
+    {
+      // Generating the solver data and saving them in the cache file
+      solver = (Solver *) g_malloc0 (sizeof (Solver));
+      solver_init_stencil (solver, nrows, ncolumns, stencil);
+      if (cache_save (file, SOLVER_VERSION, nrows, ncolumns, solver,
+                      sizeof (Solver)))
+        cached = (const Solver *)
+          cache_open (file, SOLVER_VERSION, nrows, ncolumns, sizeof (Solver),
+                      mapped);
+      if (cached)
+        g_free (solver);
+      else
+        cached = solver;
+    }
+  g_free (file);
+  return cached;
 }
 
 /**
- * Function to generate a new game.
+ * Function to close the solver data opened by solver_open.
  */
 void
-game_new ()
+solver_close (const Solver * solver,    ///< solver data.
+              GMappedFile * mapped)     ///< mapped cache file.
 {
-  GRand *rand;
-  uint64_t m;
-  unsigned int i, j;
-  game_init ();
-  rand = g_rand_new ();
-  m = 0L;
-  for (i = 0; i < level; ++i)
+  if (mapped)
+    g_mapped_file_unref (mapped);
+  else
+    g_free ((Solver *) solver);
+}
+
+/**
+ * Function to generate the null space combinations of the optimal solutions
+ * of every game status of a small board. The game status are run in Gray
+ * code order, adding on every step the solution of the switched light, and
+ * the null space combinations are checked in the order of minimize_word, so
+ * the table gives the same solutions.
+ */
+static void
+generate_table (SolverTable * table,    ///< optimal solutions table.
+                const Solver * solver,  ///< solver data.
+                uint8_t * combination)
+                ///< table of the null space combinations.
+{
+  uint64_t k, status, m;
+  unsigned int i, j, n, nmin, optimal;
+  memset (combination, 0, 1L << (solver->nsquares - 1));
+  for (k = m = 0L; k < (1L << solver->nsquares); ++k)
     {
-      do
-        j = g_rand_int_range (rand, 0, nsquares);
-      while (!((~m) & (1L << j)));
-      m |= (1L << j);
-      move (&status, j);
+      if (k)
+        m ^= solver->solution_array[__builtin_ctzll (k)];
+      status = k ^ (k >> 1);
+      nmin = __builtin_popcountll (m);
+      for (i = 1, optimal = 0; i < (1U << solver->nnull); ++i)
+        {
+          j = i ^ (i >> 1);
+          n = __builtin_popcountll (m ^ table->null[j]);
+          if (n < nmin)
+            nmin = n, optimal = j;
+        }
+      combination[status >> 1] |= optimal << ((status & 1L) << 2);
     }
-  g_rand_free (rand);
 }
 
 /**
- * Function to do one movement.
+ * Function to map an optimal solutions table file saved with the same solver
+ * basis, as the table saves the null space combinations relative to it.
  *
- * \return type of movement hunting the light.
+ * \return mapped table of the null space combinations, NULL on error.
  */
-static inline int
-hunt (uint64_t * status)        ///< bits chain codifying the game status.
+static const uint8_t *
+solver_table_map (SolverTable * table,  ///< optimal solutions table.
+                  const char *file,     ///< table file.
+                  const Solver * solver,        ///< solver data.
+                  const uint64_t * basis,       ///< solver basis.
+                  uint64_t size)        ///< size of the table in bytes.
 {
-  unsigned int i, n;
-  n = nsquares - ncolumns;
+  const uint64_t *data;
+  data = (const uint64_t *)
+    cache_open (file, TABLE_VERSION, solver->nrows, solver->ncolumns,
+                TABLE_BASIS * sizeof (uint64_t) + size, &table->mapped);
+  if (!data)
+    return NULL;
+  if (memcmp (data, basis, TABLE_BASIS * sizeof (uint64_t)))
+    {
+      // Discarding a table saved with other solver basis
+      g_mapped_file_unref (table->mapped);
+      table->mapped = NULL;
+      return NULL;
+    }
+  return (const uint8_t *) (data + TABLE_BASIS);
+}
+
+/**
+ * Function to open the optimal solutions table of a small board size mapping
+ * the cache file. The tables are only useful on board sizes with null space
+ * (up to 4 dimensions, saved in 4 bits).
+ *
+ * \return 1 if the table is mapped, 0 otherwise.
+ */
+int
+solver_table_open (SolverTable * table, ///< optimal solutions table.
+                   const Solver * solver,       ///< solver data.
+                   const char *directory,
+                   ///< cache directory (NULL to use the user cache directory).
+                   int build)
+                   ///< 1 to generate and save the table if it does not exist.
+{
+  uint64_t basis[TABLE_BASIS];
+  uint64_t *data;
+  char *file;
+  uint64_t size;
+  unsigned int i, j;
+
+  // Checking the board size
+  table->mapped = NULL;
+  table->combination = NULL;
+  if (solver->nsquares > N_TABLE_SQUARES || !solver->nnull
+      || solver->nnull > 4)
+    return 0;
+
+  // Solutions of the low and high lights and null space combinations
+  for (i = 0; i < (1U << N_TABLE_LOW); ++i)
+    for (table->low[i] = 0, j = i; j; j &= j - 1)
+      table->low[i] ^= solver->solution_array[__builtin_ctz (j)];
+  for (i = 0; i < (1U << (N_TABLE_SQUARES - N_TABLE_LOW)); ++i)
+    for (table->high[i] = 0, j = i; j; j &= j - 1)
+      table->high[i]
+        ^= solver->solution_array[N_TABLE_LOW + __builtin_ctz (j)];
+  for (i = 0; i < (1U << solver->nnull); ++i)
+    for (table->null[i] = 0, j = i; j; j &= j - 1)
+      table->null[i] ^= solver->null_array[__builtin_ctz (j)];
+
+  // Solver basis the table depends on
+  memset (basis, 0, sizeof (basis));
+  memcpy (basis, solver->solution_array,
+          solver->nsquares * sizeof (uint64_t));
+  memcpy (basis + N_TABLE_SQUARES, solver->null_array,
+          solver->nnull * sizeof (uint64_t));
+
+  // Mapping the table, generating and saving it if it does not exist or it
+  // was saved with other solver basis
+  file = solver_cache_name (directory, "table", solver->nrows,
+                            solver->ncolumns, solver->stencil);
+  size = 1L << (solver->nsquares - 1);
+  table->combination = solver_table_map (table, file, solver, basis, size);
+  if (!table->combination && build)
+    {
+      data = (uint64_t *) g_malloc (sizeof (basis) + size);
+      memcpy (data, basis, sizeof (basis));
+      generate_table (table, solver, (uint8_t *) (data + TABLE_BASIS));
+      if (cache_save (file, TABLE_VERSION, solver->nrows, solver->ncolumns,
+                      data, sizeof (basis) + size))
+        table->combination
+          = solver_table_map (table, file, solver, basis, size);
+      g_free (data);
+    }
+  g_free (file);
+  return table->mapped != NULL;
+}
+
+/**
+ * Function to close an optimal solutions table.
+ */
+void
+solver_table_close (SolverTable * table)        ///< optimal solutions table.
+{
+  if (table->mapped)
+    g_mapped_file_unref (table->mapped);
+  table->mapped = NULL;
+  table->combination = NULL;
+}
+
+/**
+ * Function to init a new game. The game has to be zero-initialized before the
+ * first call.
+ */
+void
+game_init (LightsOffGame * game,        ///< game.
+           unsigned int nrows,  ///< rows number.
+           unsigned int ncolumns)       ///< columns number.
+{
+  unsigned int i;
+  if (nrows != game->solver.nrows || ncolumns != game->solver.ncolumns)
+    {
+      solver_table_close (&game->table);
+      solver_init (&game->solver, nrows, ncolumns);
+      solver_table_open (&game->table, &game->solver, NULL, 0);
+      for (i = 0; i < game->solver.nsquares; ++i)
+        game->square[i] = i;
+    }
+  board_zero (&game->status, game->solver.nwords);
+  board_zero (&game->solution, game->solver.nwords);
+  game->nmovements = 0;
+}
+
+/**
+ * Function to seed a xoshiro256** pseudo-random numbers generator, filling the
+ * state by a splitmix64 sequence (never all zeros).
+ */
+void
+game_rand_seed (GameRand * rand,        ///< pseudo-random numbers generator.
+                uint64_t seed)  ///< seed.
+{
+  uint64_t z;
+  unsigned int i;
+  for (i = 0; i < 4; ++i)
+    {
+      seed += 0x9e3779b97f4a7c15L;
+      z = seed;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9L;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebL;
+      rand->state[i] = z ^ (z >> 31);
+    }
+}
+
+/**
+ * Function to generate a new game with a pseudo-random numbers generator. The
+ * distinct movements are selected by a partial Fisher-Yates shuffle of the
+ * squares permutation of the game, undone at the end to get the same game from
+ * the same generator state, so the cost is proportional to the level.
+ */
+void
+game_new_rand (LightsOffGame * game,    ///< game.
+               GameRand * rand) ///< pseudo-random numbers generator.
+{
+  uint16_t swap[N_MAX_SQUARES];
+  unsigned int i, j, k, n, nsquares;
+  nsquares = game->solver.nsquares;
+  n = MIN (game->level, nsquares);
+  board_zero (&game->status, game->solver.nwords);
   for (i = 0; i < n; ++i)
     {
-      if (*status & (1L << i))
+      swap[i] = j = i + game_rand_range (rand, nsquares - i);
+      k = game->square[j], game->square[j] = game->square[i];
+      game->square[i] = k;
+      game_move (game, k);
+    }
+
+  // Restoring the squares permutation
+  while (i-- > 0)
+    {
+      j = swap[i];
+      k = game->square[j], game->square[j] = game->square[i];
+      game->square[i] = k;
+    }
+}
+
+/**
+ * Function to generate a new game reproducible from a seed.
+ */
+void
+game_new_seed (LightsOffGame * game,    ///< game.
+               uint64_t seed)   ///< seed.
+{
+  GameRand rand;
+  game->seed = seed;
+  game_rand_seed (&rand, seed);
+  game_new_rand (game, &rand);
+}
+
+/**
+ * Function to generate a new game with a random seed.
+ */
+void
+game_new (LightsOffGame * game) ///< game.
+{
+  game_new_seed (game, ((uint64_t) g_random_int () << 32) | g_random_int ());
+}
+
+/**
+ * Function to search the combination of a solution with the null space of
+ * minimum movements on one word boards with a given null space dimension.
+ * Inlined with a constant dimension, the loops are fully unrolled.
+ *
+ * \return number of movements.
+ */
+static inline __attribute__ ((always_inline)) int
+minimize_word_null (const Solver * solver,      ///< solver data.
+                    uint64_t m, ///< bits chain codifying a solution.
+                    uint64_t * solution,
+                    ///< bits chain codifying the optimal movements.
+                    SolverStats * stats,
+                    ///< instrumentation counters (NULL to not save them).
+                    unsigned int nnull) ///< null space dimension.
+{
+  uint64_t k, optimal;
+  unsigned int n, nmin;
+
+  // Descending on large null spaces while a vector reduces the movements (the
+  // solution is not guaranteed optimal)
+  nmin = __builtin_popcountll (m);
+  if (nnull > N_MAX_SEARCH)
+    {
+      for (k = 0L; k < nnull; ++k)
         {
-          move (status, i + ncolumns);
-          break;
+          n = __builtin_popcountll (m ^ solver->null_array[k]);
+          if (n < nmin)
+            {
+              nmin = n;
+              m ^= solver->null_array[k];
+              k = -1L;
+              STATS_ADD (stats, improvements, 1);
+            }
         }
+      *solution = m;
+      return nmin;
     }
-  if (i == n)
-    return 0;
-  return i + ncolumns;
+
+  // Searching in Gray code order
+  optimal = m;
+  STATS_ADD (stats, nodes, 1L << nnull);
+  for (k = 1L; k < (1L << nnull); ++k)
+    {
+      m ^= solver->null_array[__builtin_ctzll (k)];
+      n = __builtin_popcountll (m);
+      if (n < nmin)
+        {
+          // Saving a better solution
+          nmin = n;
+          optimal = m;
+          STATS_ADD (stats, improvements, 1);
+        }
+    }
+  *solution = optimal;
+  return nmin;
 }
 
 /**
- * Function to elliminate lights by the hunt algorithm.
+ * Function to search the combination of a solution with the null space of
+ * minimum movements on one word boards.
  *
- * \return on succes: number of movements; on failure: 0.
+ * \return number of movements.
  */
-static unsigned int
-play_hunt (uint64_t status,     ///< bits chain codifying the game status.
-           unsigned int depth,  ///< number of past movements.
-           unsigned int *movement)      ///< array of movements.
+static inline int
+minimize_word (const Solver * solver,   ///< solver data.
+               uint64_t m,      ///< bits chain codifying a solution.
+               uint64_t * solution,
+               ///< bits chain codifying the optimal movements.
+               SolverStats * stats)
+               ///< instrumentation counters (NULL to not save them).
 {
-  uint64_t j, m;
-  unsigned int i, n;
-  n = nsquares - ncolumns;
-  m = (1L << n) - 1;
-  j = status;
-  do
-    {
-      ++depth;
-      i = hunt (&j);
-      movement[depth - 1] = i;
-      if (!j)
-        return depth;
-    }
-  while (j & m);
-  return 0;
+  return minimize_word_null (solver, m, solution, stats, solver->nnull);
 }
 
 /**
- * Function to solve the game recursively.
+ * Function to search the optimal play to elliminate the lights on one word
+ * boards with a given null space dimension (equal to the number of parity
+ * masks, as the movements matrix is square).
+ *
+ * \return on succes: number of movements; on failure: -1.
  */
-static void
-play_recursive (uint64_t status,
-///< bits chain codifying the game status.
-                unsigned int depth,     ///< number of past movements.
-                unsigned int ii,
-///< index of the minimum allowed movement.
-                unsigned int *m,        ///< array of current movements.
-                unsigned int *kmax,
-///< number of movements of the current best play.
-                unsigned int *movement) ///< array of optimal movements.
+static inline __attribute__ ((always_inline)) int
+play_word_null (const Solver * solver,  ///< solver data.
+                uint64_t status,        ///< bits chain codifying the game status.
+                uint64_t * solution,    ///< bits chain codifying the movements.
+                SolverStats * stats,
+                ///< instrumentation counters (NULL to not save them).
+                unsigned int nnull)     ///< null space dimension.
 {
+  uint64_t m, j;
+  unsigned int i;
+
+  // Checking obvious solution
+  if (!status)
+    {
+      *solution = 0L;
+      return 0;
+    }
+
+  // Checking if the solution exists
+  for (i = 0; i < nnull; ++i)
+    if (__builtin_parityll (status & solver->parity_array[i]))
+      return -1;
+
+  // Adding the movements solving every light
+  for (m = 0L, j = status; j; j &= j - 1)
+    m ^= solver->solution_array[__builtin_ctzll (j)];
+
+  return minimize_word_null (solver, m, solution, stats, nnull);
+}
+
+///> Macro to define a one word solver specialized on a null space dimension.
+#define PLAY_WORD(nnull) \
+  static int \
+  play_word_##nnull (const Solver * solver, uint64_t status, \
+                     uint64_t * solution, SolverStats * stats) \
+  { \
+    return play_word_null (solver, status, solution, stats, nnull); \
+  }
+
+PLAY_WORD (0)
+PLAY_WORD (1)
+PLAY_WORD (2)
+PLAY_WORD (3)
+PLAY_WORD (4)
+PLAY_WORD (5)
+PLAY_WORD (6)
+
+/**
+ * Function to search the optimal play to elliminate the lights on one word
+ * boards with any null space dimension.
+ *
+ * \return on succes: number of movements; on failure: -1.
+ */
+static int
+play_word_any (const Solver * solver,   ///< solver data.
+               uint64_t status, ///< bits chain codifying the game status.
+               uint64_t * solution,     ///< bits chain codifying the movements.
+               SolverStats * stats)
+               ///< instrumentation counters (NULL to not save them).
+{
+  return play_word_null (solver, status, solution, stats, solver->nnull);
+}
+
+///> Array of one word solvers indexed by the null space dimension, the last
+///> one for any dimension. The index is saved in the solver data, so the
+///> mapped cache files do not save function addresses.
+static int (*const play_word_kernel[N_PLAY_WORD + 1])
+  (const Solver *, uint64_t, uint64_t *, SolverStats *) = {
+  play_word_0, play_word_1, play_word_2, play_word_3, play_word_4,
+  play_word_5, play_word_6, play_word_any
+};
+
+/**
+ * Function to search the optimal play to elliminate the lights on one word
+ * boards by the solver specialized on the null space dimension. Boards
+ * without null space, the most common, are solved inline without the
+ * indirect call.
+ *
+ * \return on succes: number of movements; on failure: -1.
+ */
+static inline int
+play_word (const Solver * solver,       ///< solver data.
+           uint64_t status,     ///< bits chain codifying the game status.
+           uint64_t * solution, ///< bits chain codifying the movements.
+           SolverStats * stats)
+           ///< instrumentation counters (NULL to not save them).
+{
+  if (!solver->nnull)
+    return play_word_null (solver, status, solution, stats, 0);
+  return play_word_kernel[solver->kernel] (solver, status, solution, stats);
+}
+
+/**
+ * Function to transpose SLICE_WIDTH 64x64 bits matrices at once: the word w
+ * of a[i] is the row i of the matrix w.
+ */
+static inline __attribute__ ((always_inline)) void
+transpose64 (SliceVector * a)   ///< array of matrices rows.
+{
+  SliceVector t;
+  uint64_t m;
+  unsigned int j, k;
+  for (j = 32, m = 0x00000000FFFFFFFFL; j; j >>= 1, m ^= m << j)
+    for (k = 0; k < 64; k = ((k | j) + 1) & ~j)
+      {
+        t = ((a[k] >> j) ^ a[k | j]) & m;
+        a[k] ^= t << j;
+        a[k | j] ^= t;
+      }
+}
+
+/**
+ * Function to solve SLICE_BOARDS one word boards at once: the boards are
+ * transposed, so every vector codifies a square of all the boards, and the
+ * solution and parity arrays are applied to all the boards by vector XORs.
+ */
+static inline __attribute__ ((always_inline)) void
+play_slice_kernel (const Solver * solver,       ///< solver data.
+                   const uint64_t * boards,     ///< array of boards.
+                   int *results,        ///< array of movements numbers.
+                   uint64_t * solutions)        ///< array of optimal movements.
+{
+  const SliceVector zero = { 0L };
+  SliceVector b[64], m[64], u, z;
   uint64_t j;
-  unsigned int i, k;
+  unsigned int i, n, w;
+
+  // Transposing the boards: b[i] codifies the square i of all the boards
+  n = solver->nsquares;
+  for (i = 0; i < 64; ++i)
+    for (w = 0; w < SLICE_WIDTH; ++w)
+      b[i][w] = boards[w * 64 + i];
+  transpose64 (b);
+
+  // Adding the lights switched by every movement of the solution
+  for (i = 0; i < n; ++i)
+    for (m[i] = zero, j = solver->slice_array[i]; j; j &= j - 1)
+      m[i] ^= b[__builtin_ctzll (j)];
+  for (; i < 64; ++i)
+    m[i] = zero;
+
+  // Checking the parity masks
+  u = zero;
+  for (i = 0; i < solver->nparity; ++i)
+    {
+      for (z = zero, j = solver->parity_array[i]; j; j &= j - 1)
+        z ^= b[__builtin_ctzll (j)];
+      u |= z;
+    }
+
+  // Transposing back the solutions and minimizing every board
+  transpose64 (m);
+  for (w = 0; w < SLICE_WIDTH; ++w)
+    for (i = 0; i < 64; ++i, ++results, ++solutions)
+      if ((u[w] >> i) & 1L)
+        *results = -1;
+      else
+        *results = minimize_word (solver, m[i][w], solutions, NULL);
+}
+
+/**
+ * Function to solve SLICE_BOARDS one word boards at once with the default
+ * instructions set.
+ */
+static void
+play_slice_default (const Solver * solver,      ///< solver data.
+                    const uint64_t * boards,    ///< array of boards.
+                    int *results,       ///< array of movements numbers.
+                    uint64_t * solutions)       ///< array of optimal movements.
+{
+  play_slice_kernel (solver, boards, results, solutions);
+}
+
+#if SLICE_AVX2
+
+/**
+ * Function to solve SLICE_BOARDS one word boards at once with AVX2
+ * instructions.
+ */
+static __attribute__ ((target ("avx2,popcnt"))) void
+play_slice_avx2 (const Solver * solver, ///< solver data.
+                 const uint64_t * boards,       ///< array of boards.
+                 int *results,  ///< array of movements numbers.
+                 uint64_t * solutions)  ///< array of optimal movements.
+{
+  play_slice_kernel (solver, boards, results, solutions);
+}
+
+#endif
+
+/**
+ * Function to solve an array of one word boards by the bitsliced kernel. The
+ * AVX2 kernel is selected at runtime if the processor supports it.
+ */
+void
+play_slice (const Solver * solver,      ///< solver data.
+            const uint64_t * boards,    ///< array of boards.
+            unsigned int n,     ///< number of boards.
+            int *results,
+///< array of numbers of optimal movements (-1 on unsolvable boards).
+            uint64_t * solutions)
+///< array of optimal movements (NULL to not save them).
+{
+  uint64_t b[SLICE_BOARDS], s[SLICE_BOARDS];
+  int r[SLICE_BOARDS];
+  void (*kernel) (const Solver *, const uint64_t *, int *, uint64_t *);
+
+  // Selecting the kernel
+  kernel = play_slice_default;
+#if SLICE_AVX2
+#ifdef __AVX2__
+  kernel = play_slice_avx2;
+#else
+  if (__builtin_cpu_supports ("avx2"))
+    kernel = play_slice_avx2;
+#endif
+#endif
+
+  // Solving by blocks
+  for (; n >= SLICE_BOARDS; n -= SLICE_BOARDS)
+    {
+      kernel (solver, boards, results, solutions ? solutions : s);
+      boards += SLICE_BOARDS;
+      results += SLICE_BOARDS;
+      if (solutions)
+        solutions += SLICE_BOARDS;
+    }
+
+  // Rest of boards
+  if (!n)
+    return;
+  memcpy (b, boards, n * sizeof (uint64_t));
+  memset (b + n, 0, (SLICE_BOARDS - n) * sizeof (uint64_t));
+  kernel (solver, b, r, s);
+  memcpy (results, r, n * sizeof (int));
+  if (solutions)
+    memcpy (solutions, s, n * sizeof (uint64_t));
+}
 
-  // Checking lights hunt doing one movement at top
-  for (i = ii; i < ncolumns; ++i)
+/**
+ * Function to search the combination of a solution with the null space of
+ * minimum movements on multi-word boards.
+ *
+ * \return number of movements.
+ */
+static inline int
+minimize_board (const Solver * solver,  ///< solver data.
+                Board * m,      ///< board codifying a solution (modified).
+                Board * solution,
+                ///< board codifying the optimal movements.
+                SolverStats * stats)
+                ///< instrumentation counters (NULL to not save them).
+{
+  uint64_t k;
+  unsigned int n, nmin, nwords;
+
+  // Descending on large null spaces while a vector reduces the movements (the
+  // solution is not guaranteed optimal)
+  nwords = solver->nwords;
+  nmin = board_count (m, nwords);
+  if (solver->nnull > N_MAX_SEARCH)
     {
-      j = status;
-      move (&j, i);
-      m[depth - 1] = i;
-      if (!j && depth < *kmax)
+      for (k = 0L; k < solver->nnull; ++k)
         {
-          // Saving a better solution
-          *kmax = depth;
-          memcpy (movement, m, *kmax * sizeof (unsigned int));
+          n = board_xor_count (m, solver->null_board + k, nwords);
+          if (n < nmin)
+            {
+              nmin = n;
+              k = -1L;
+              STATS_ADD (stats, improvements, 1);
+            }
+          else
+            board_xor (m, solver->null_board + k, nwords);
         }
-      k = play_hunt (j, depth, m);
-      if (k && k < *kmax)
+      *solution = *m;
+      return nmin;
+    }
+
+  // Searching in Gray code order: every combination differs from the previous
+  // one in a vector, so it is added and counted in one pass
+  *solution = *m;
+  STATS_ADD (stats, nodes, 1L << solver->nnull);
+  for (k = 1L; k < (1L << solver->nnull); ++k)
+    {
+      n = board_xor_count (m, solver->null_board + __builtin_ctzll (k),
+                           nwords);
+      if (n < nmin)
         {
           // Saving a better solution
-          *kmax = k;
-          memcpy (movement, m, *kmax * sizeof (unsigned int));
+          nmin = n;
+          *solution = *m;
+          STATS_ADD (stats, improvements, 1);
         }
-      // Trying another movement at top
-      if (depth < ncolumns)
-        play_recursive (j, depth + 1, i + 1, m, kmax, movement);
     }
+  return nmin;
 }
 
 /**
- * Function to search the optimal play to elliminate the lights.
+ * Function to search the optimal play to elliminate the lights on multi-word
+ * boards.
  *
  * \return on succes: number of movements; on failure: -1.
  */
-int
-play ()
+static int
+play_board (const Solver * solver,      ///< solver data.
+            const Board * status,       ///< board codifying the game status.
+            Board * solution,   ///< board codifying the movements.
+            SolverStats * stats)
+            ///< instrumentation counters (NULL to not save them).
 {
-  unsigned int m[N_MAX_SQUARES];
-  unsigned int k, kmax;
+  Board m;
+  uint64_t r, j;
+  unsigned int i, nwords;
 
   // Checking obvious solution
-  if (!status)
+  nwords = solver->nwords;
+  if (board_is_zero (status, nwords))
+    {
+      board_zero (solution, nwords);
+      return 0;
+    }
+
+  // Checking if the solution exists
+  if (!solver_is_solvable (solver, status))
+    return -1;
+
+  if (solver->stencil != SOLVER_STENCIL_PLUS)
+    {
+      // Adding the movements solving every light on other neighbourhoods
+      board_zero (&m, nwords);
+      for (i = 0; i < nwords; ++i)
+        for (j = status->word[i]; j; j &= j - 1)
+          board_xor (&m, solver->solution_board + i * N_WORD_SQUARES
+                     + __builtin_ctzll (j), nwords);
+      return minimize_board (solver, &m, solution, stats);
+    }
+
+  // Chasing the lights to the bottom row
+  r = chase (solver, status, 0L, &m);
+  STATS_ADD (stats, chases, solver->nrows - 1);
+
+  // Adding the chases of the top row movements switching the bottom row lights
+  for (j = 0L; r; r &= r - 1)
+    j ^= solver->chase_solution[__builtin_ctzll (r)];
+  for (; j; j &= j - 1)
+    board_xor (&m, solver->chase_board + __builtin_ctzll (j), nwords);
+
+  // Searching the combination with the null space of minimum movements
+  return minimize_board (solver, &m, solution, stats);
+}
+
+/**
+ * Function to search the optimal play to elliminate the lights of a board.
+ * It is reentrant: the solver data are only read.
+ *
+ * \return on succes: number of movements; on failure: -1.
+ */
+int
+solver_solve (const Solver * solver,    ///< solver data.
+              const Board * status,     ///< board codifying the game status.
+              Board * solution,
+              ///< board codifying the optimal movements.
+              SolverStats * stats)
+              ///< instrumentation counters (NULL to not save them).
+{
+#if STATS
+  struct timespec t0, t;
+  int n;
+  if (stats)
+    {
+      memset (stats, 0, sizeof (SolverStats));
+      clock_gettime (CLOCK_MONOTONIC, &t0);
+    }
+  if (solver->nwords == 1)
+    n = play_word (solver, status->word[0], solution->word, stats);
+  else
+    n = play_board (solver, status, solution, stats);
+  if (stats)
+    {
+      clock_gettime (CLOCK_MONOTONIC, &t);
+      stats->time = (t.tv_sec - t0.tv_sec) * 1000000000L
+        + t.tv_nsec - t0.tv_nsec;
+    }
+  return n;
+#else
+  // One word fast path
+  if (solver->nwords == 1)
+    return play_word (solver, status->word[0], solution->word, stats);
+  return play_board (solver, status, solution, stats);
+#endif
+}
+
+/**
+ * Function to minimize a solution of a board combining it with the null space.
+ *
+ * \return number of movements of the optimal solution.
+ */
+int
+solver_minimize (const Solver * solver, ///< solver data.
+                 Board * solution)
+                 ///< board codifying a solution, replaced by the optimal one.
+{
+  Board m;
+  if (solver->nwords == 1)
+    return minimize_word (solver, solution->word[0], solution->word, NULL);
+  m = *solution;
+  return minimize_board (solver, &m, solution, NULL);
+}
+
+/**
+ * Function to count the optimal solutions of a board: the combinations of an
+ * optimal solution with the null space with the same number of movements.
+ *
+ * \return number of optimal solutions, 0 if the null space is too large to be
+ * searched.
+ */
+unsigned int
+solver_optimal_number (const Solver * solver,   ///< solver data.
+                       const Board * solution)
+                       ///< board codifying an optimal solution.
+{
+  Board m;
+  uint64_t k;
+  unsigned int n, nmin, nwords;
+  if (solver->nnull > N_MAX_SEARCH)
     return 0;
+  nwords = solver->nwords;
+  m = *solution;
+  nmin = board_count (&m, nwords);
+  for (k = 1L, n = 1; k < (1L << solver->nnull); ++k)
+    if (nwords == 1)
+      {
+        m.word[0] ^= solver->null_array[__builtin_ctzll (k)];
+        n += (__builtin_popcountll (m.word[0]) == nmin);
+      }
+    else
+      n += (board_xor_count (&m, solver->null_board + __builtin_ctzll (k),
+                             nwords) == nmin);
+  return n;
+}
+
+/**
+ * Function to enumerate the solutions of a board with a number of movements
+ * up to a maximum, streaming them to a callback without saving them. The
+ * combinations with the null space are searched in Gray code order, but the
+ * combinations over the maximum are skipped, so consecutive solutions can
+ * differ in several null space vectors.
+ *
+ * \return on succes: number of enumerated solutions; on failure (unsolvable
+ * board or null space too large to be searched): -1.
+ */
+long int
+solver_enumerate (const Solver * solver,        ///< solver data.
+                  const Board * status, ///< board codifying the game status.
+                  int max_movements,
+                  ///< maximum number of movements (-1 to enumerate only the
+                  ///< optimal solutions).
+                  SolverCallback callback,
+                  ///< function called on every solution.
+                  void *data)   ///< user data passed to the callback.
+{
+  Board m;
+  uint64_t k;
+  long int n;
+  unsigned int nwords, nmovements;
+  int nmin;
 
-  // Setting an upper limit of movements number
-  kmax = nsquares + 1;
+  // Checking if the solutions can be enumerated
+  if (solver->nnull > N_MAX_SEARCH)
+    return -1;
+  nmin = solver_solve (solver, status, &m, NULL);
+  if (nmin < 0)
+    return -1;
+  if (max_movements < 0)
+    max_movements = nmin;
 
-  // Checking lights hunt without movements at top
-  k = play_hunt (status, 0, m);
-  if (k)
+  // Searching in Gray code order from an optimal solution
+  nwords = solver->nwords;
+  nmovements = nmin;
+  n = 0L;
+  for (k = 0L; k < (1L << solver->nnull); ++k)
     {
-      // Saving a solution
-      kmax = k;
-      memcpy (movement, m, kmax * sizeof (unsigned int));
+      if (k)
+        {
+          if (nwords == 1)
+            {
+              m.word[0] ^= solver->null_array[__builtin_ctzll (k)];
+              nmovements = __builtin_popcountll (m.word[0]);
+            }
+          else
+            nmovements = board_xor_count (&m, solver->null_board
+                                          + __builtin_ctzll (k), nwords);
+        }
+      if (nmovements <= (unsigned int) max_movements)
+        {
+          ++n;
+          if (!callback (&m, nmovements, data))
+            break;
+        }
     }
+  return n;
+}
 
-  // Traying lights hunt making movement combinations at top
-  play_recursive (status, 1, 0, m, &kmax, movement);
+/**
+ * Function to take boards to solve in a batch thread: first from its own
+ * range, then stealing the half of the range of other thread.
+ *
+ * \return 1 on succes, 0 if there are not boards to solve.
+ */
+static int
+play_batch_take (BatchThread * data,    ///< batch thread data.
+                 unsigned int *begin,   ///< index of the first board taken.
+                 unsigned int *end)     ///< index of the last board taken + 1.
+{
+  BatchRange *range, *victim;
+  unsigned int i, n;
 
-  // Checking if the solution exists
-  if (kmax <= nsquares)
-    return kmax;
+  // Taking a chunk from the own range
+  range = data->range + data->thread;
+  g_mutex_lock (&range->mutex);
+  if (range->begin < range->end)
+    {
+      *begin = range->begin;
+      *end = MIN (range->end, *begin + BATCH_CHUNK);
+      range->begin = *end;
+      g_mutex_unlock (&range->mutex);
+      return 1;
+    }
+  g_mutex_unlock (&range->mutex);
 
-  // Unable to find a solution
-  return -1;
+  // Stealing the upper half of the range of other thread
+  for (i = 1; i < data->nthreads; ++i)
+    {
+      victim = data->range + (data->thread + i) % data->nthreads;
+      g_mutex_lock (&victim->mutex);
+      n = victim->end - victim->begin;
+      if (victim->begin < victim->end)
+        {
+          *end = victim->end;
+          victim->end -= (n + 1) / 2;
+          *begin = victim->end;
+          g_mutex_unlock (&victim->mutex);
+          if (*end - *begin > BATCH_CHUNK)
+            {
+              // Saving the rest of the stolen range as own range
+              g_mutex_lock (&range->mutex);
+              range->begin = *begin + BATCH_CHUNK;
+              range->end = *end;
+              g_mutex_unlock (&range->mutex);
+              *end = *begin + BATCH_CHUNK;
+            }
+          return 1;
+        }
+      g_mutex_unlock (&victim->mutex);
+    }
+  return 0;
+}
+
+/**
+ * Function to solve boards in a batch thread.
+ *
+ * \return NULL.
+ */
+static gpointer
+play_batch_thread (BatchThread * data)  ///< batch thread data.
+{
+  Board board, solution;
+  const Solver *solver;
+  unsigned int i, begin, end, nwords;
+  solver = data->solver;
+  nwords = solver->nwords;
+
+  // Bitsliced kernels on one word boards (the instrumentation counters are
+  // saved board by board)
+  if (nwords == 1 && !(STATS && data->stats))
+    {
+      while (play_batch_take (data, &begin, &end))
+        play_slice (solver, data->boards + begin, end - begin,
+                    data->results + begin,
+                    data->solutions ? data->solutions + begin : NULL);
+      return NULL;
+    }
+
+  // Multi-word boards
+  while (play_batch_take (data, &begin, &end))
+    for (i = begin; i < end; ++i)
+      {
+        memcpy (board.word, data->boards + i * nwords,
+                nwords * sizeof (uint64_t));
+        data->results[i] = solver_solve (solver, &board, &solution,
+                                         data->stats ? data->stats + i : NULL);
+        if (data->solutions)
+          memcpy (data->solutions + i * nwords, solution.word,
+                  nwords * sizeof (uint64_t));
+      }
+  return NULL;
+}
+
+/**
+ * Function to solve an array of boards in parallel. The boards are packed:
+ * every board is codified in the solver number of words. The boards are
+ * evenly distributed between the threads, and a thread ending its boards
+ * steals boards of the others.
+ */
+void
+play_batch (const Solver * solver,      ///< solver data.
+            const uint64_t * boards,    ///< array of packed boards.
+            unsigned int n,     ///< number of boards.
+            int *results,
+///< array of numbers of optimal movements (-1 on unsolvable boards).
+            uint64_t * solutions,
+///< array of packed optimal movements (NULL to not save them).
+            SolverStats * stats,
+///< array of instrumentation counters (NULL to not save them).
+            unsigned int nthreads)
+///< number of threads (0 to use all the processors).
+{
+  unsigned int i;
+  if (!nthreads)
+    nthreads = g_get_num_processors ();
+  nthreads = MAX (1, MIN (nthreads, (n + BATCH_CHUNK - 1) / BATCH_CHUNK));
+  BatchRange range[nthreads];
+  BatchThread data[nthreads];
+  GThread *thread[nthreads];
+  for (i = 0; i < nthreads; ++i)
+    {
+      g_mutex_init (&range[i].mutex);
+      range[i].begin = (uint64_t) n * i / nthreads;
+      range[i].end = (uint64_t) n * (i + 1) / nthreads;
+      data[i].solver = solver;
+      data[i].boards = boards;
+      data[i].results = results;
+      data[i].solutions = solutions;
+      data[i].stats = stats;
+      data[i].range = range;
+      data[i].nthreads = nthreads;
+      data[i].thread = i;
+    }
+  for (i = 1; i < nthreads; ++i)
+    thread[i] = g_thread_new (NULL, (GThreadFunc) play_batch_thread,
+                              data + i);
+  play_batch_thread (data);
+  for (i = 1; i < nthreads; ++i)
+    g_thread_join (thread[i]);
+  for (i = 0; i < nthreads; ++i)
+    g_mutex_clear (&range[i].mutex);
+}
+
+/**
+ * Function to generate a block of games passing the filters. The games are
+ * generated by random movements: every solvable game status has the same
+ * probability, or, with a wanted number of movements, every combination of
+ * that number of distinct movements has the same probability (so a game
+ * status reached by several combinations is more probable). The games are
+ * solved in parallel and filtered.
+ *
+ * \return number of generated games.
+ */
+unsigned int
+generate_games (const Solver * solver,  ///< solver data.
+                GameRand * rand,        ///< pseudo-random numbers generator.
+                const GenerateFilter * filter,  ///< filters of the games.
+                unsigned int n, ///< number of tried games.
+                uint64_t * boards,
+                ///< array of packed boards of the games (n boards).
+                uint64_t * solutions,
+                ///< array of packed optimal movements (n boards).
+                int *results,   ///< array of numbers of movements (n boards).
+                unsigned int nthreads)
+///< number of threads (0 to use all the processors).
+{
+  Board b, m;
+  uint64_t mask;
+  unsigned int square[N_MAX_SQUARES];
+  unsigned int i, j, k, l, ngames, nlights, nsquares, nwords;
+
+  // Generating the games by random movements
+  nsquares = solver->nsquares;
+  nwords = solver->nwords;
+  for (i = 0; i < nsquares; ++i)
+    square[i] = i;
+  for (i = 0; i < n; ++i)
+    {
+      board_zero (&m, nwords);
+      if (filter->nmovements < 0)
+        for (j = 0; j < nwords; ++j)
+          {
+            m.word[j] = game_rand_next (rand);
+            if (nsquares < (j + 1) * N_WORD_SQUARES)
+              m.word[j] &= (1L << (nsquares % N_WORD_SQUARES)) - 1L;
+          }
+      else
+        for (j = 0; j < (unsigned int) filter->nmovements; ++j)
+          {
+            // Partial Fisher-Yates shuffle selecting distinct squares
+            k = j + game_rand_range (rand, nsquares - j);
+            l = square[k], square[k] = square[j], square[j] = l;
+            board_set (&m, l);
+          }
+      board_zero (&b, nwords);
+      for (j = 0; j < nwords; ++j)
+        for (mask = m.word[j]; mask; mask &= mask - 1)
+          board_move (solver, &b, j * N_WORD_SQUARES + __builtin_ctzll (mask));
+      memcpy (boards + i * nwords, b.word, nwords * sizeof (uint64_t));
+    }
+
+  // Solving the games
+  play_batch (solver, boards, n, results, solutions, NULL, nthreads);
+
+  // Filtering the games
+  for (i = ngames = 0; i < n; ++i)
+    {
+      memcpy (b.word, boards + i * nwords, nwords * sizeof (uint64_t));
+      memcpy (m.word, solutions + i * nwords, nwords * sizeof (uint64_t));
+      nlights = board_count (&b, nwords);
+      if ((filter->nmovements >= 0 && results[i] != filter->nmovements)
+          || nlights < filter->min_lights || nlights > filter->max_lights
+          || (filter->unique && solver->nnull
+              && solver_optimal_number (solver, &m) != 1))
+        continue;
+      if (i != ngames)
+        {
+          memcpy (boards + ngames * nwords, b.word,
+                  nwords * sizeof (uint64_t));
+          memcpy (solutions + ngames * nwords, m.word,
+                  nwords * sizeof (uint64_t));
+          results[ngames] = results[i];
+        }
+      ++ngames;
+    }
+  return ngames;
+}
+
+/**
+ * Function to search the optimal play to elliminate the lights, saving the
+ * pressed squares of the optimal solution.
+ *
+ * \return on succes: number of movements; on failure: -1.
+ */
+int
+play (LightsOffGame * game)     ///< game.
+{
+  int n;
+
+  // Small boards with optimal solutions table
+  if (game->table.mapped)
+    {
+      memset (&game->stats, 0, sizeof (SolverStats));
+      n = solver_table_solve (&game->table, &game->solver,
+                              game->status.word[0], game->solution.word);
+    }
+  else
+    n = solver_solve (&game->solver, &game->status, &game->solution,
+                      &game->stats);
+  if (n < 0)
+    board_zero (&game->solution, game->solver.nwords);
+  game->nmovements = n;
+  return n;
 }
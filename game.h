@@ -36,19 +36,238 @@ OF SUCH DAMAGE.
 #ifndef GAME__H
 #define GAME__H 1
 
-#define N_MAX_ROWS 8            ///< Maximum number of rows.
-#define N_MAX_COLUMNS 8         ///< Maximum number of columns.
+#define N_MAX_ROWS 32           ///< Maximum number of rows.
+#define N_MAX_COLUMNS 32        ///< Maximum number of columns.
 #define N_MAX_SQUARES (N_MAX_ROWS * N_MAX_COLUMNS)
 ///< Maximum number of squares.
+#define N_WORD_SQUARES 64       ///< Number of squares codified in a word.
+#define N_MAX_WORDS (N_MAX_SQUARES / N_WORD_SQUARES)
+///< Maximum number of words of a board.
+#define N_TABLE_SQUARES 25
+///< Maximum number of squares of the boards with optimal solutions tables.
+#define N_TABLE_LOW 13
+///< Number of low lights of the solutions tables.
+#define N_MAX_NULL N_MAX_SQUARES
+///< Maximum dimension of the null space on multi-word boards (a free movement
+///< per square on the general solver).
+#define N_MAX_SEARCH 24
+///< Maximum dimension of the null space searched for optimal solutions.
+#ifndef STATS
+#define STATS 0
+///< Macro to build the solver instrumentation counters (set by configure).
+#endif
+
+///> Enumeration to define the neighbourhood switched by a movement.
+enum SolverStencil
+{
+  SOLVER_STENCIL_PLUS = 0,      ///< Square and orthogonal neighbours.
+  SOLVER_STENCIL_X = 1,         ///< Square and diagonal neighbours.
+  SOLVER_STENCIL_SQUARE = 2,    ///< Square and the 8 neighbours.
+  SOLVER_STENCIL_KNIGHT = 3,    ///< Square and the 8 knight jumps.
+  SOLVER_STENCIL_TORUS = 4,     ///< Flag to wrap around the board edges.
+};
+
+///> Number of neighbourhoods.
+#define N_STENCILS 4
+
+///> Struct to define a multi-word bits chain codifying the game status.
+typedef struct
+{
+  uint64_t word[N_MAX_WORDS];   ///< Array of bits chain words.
+} Board;
+
+///> Struct to define the xoshiro256** pseudo-random numbers generator.
+typedef struct
+{
+  uint64_t state[4];            ///< Generator state.
+} GameRand;
+
+///> Struct to define the instrumentation counters of a solve (only filled if
+///> the program is built with STATS).
+typedef struct
+{
+  uint64_t nodes;               ///< Null space combinations checked.
+  uint64_t chases;              ///< Rows chased.
+  uint64_t improvements;        ///< Improvements of the best solution.
+  uint64_t time;                ///< Wall time in nanoseconds.
+} SolverStats;
+
+///> Struct to define the solver data of a board size.
+typedef struct
+{
+  ///> Array of possible movements codified in one word bit chains.
+  uint64_t movements_array[N_WORD_SQUARES];
+  ///> Array of possible movements codified in boards.
+  Board movements_board[N_MAX_SQUARES];
+  ///> Array of movements combinations switching every single light.
+  uint64_t solution_array[N_WORD_SQUARES];
+  ///> Basis of the movements combinations not changing the game status.
+  uint64_t null_array[N_WORD_SQUARES];
+  ///> Array of lights masks with even parity on every solvable game status.
+  uint64_t parity_array[N_WORD_SQUARES];
+  ///> Array of lights combined to get every movement of the solution
+  ///> (transposed solution array) for bitsliced solving.
+  uint64_t slice_array[N_WORD_SQUARES];
+  ///> Array of bottom row lights left by chasing every top row movement.
+  uint64_t chase_array[N_MAX_COLUMNS];
+  ///> Array of movements done chasing every top row movement.
+  Board chase_board[N_MAX_COLUMNS];
+  ///> Array of top row movements combinations switching every single bottom
+  ///> row light.
+  uint64_t chase_solution[N_MAX_COLUMNS];
+  ///> Array of bottom row lights masks with even parity on every solvable
+  ///> game status.
+  uint64_t chase_parity[N_MAX_COLUMNS];
+  ///> Array of movements combinations switching every single light on
+  ///> multi-word boards without plus neighbourhood.
+  Board solution_board[N_MAX_SQUARES];
+  ///> Array of lights masks with even parity on every solvable game status on
+  ///> multi-word boards.
+  Board parity_board[N_MAX_NULL];
+  ///> Basis of the movements combinations not changing the game status on
+  ///> multi-word boards.
+  Board null_board[N_MAX_NULL];
+  uint64_t row_mask;            ///< Mask of the squares of a row.
+  unsigned int nrows;           ///< Rows number.
+  unsigned int ncolumns;        ///< Columns number.
+  unsigned int nsquares;        ///< Squares number.
+  unsigned int nwords;          ///< Number of words of the boards.
+  unsigned int nnull;           ///< Dimension of the null space.
+  unsigned int nparity;         ///< Number of parity masks.
+  unsigned int stencil;         ///< Neighbourhood of the movements.
+  unsigned int kernel;          ///< Index of the specialized one word solver.
+} Solver;
+
+///> Struct to define a table of the optimal solutions of every game status of a
+///> small board size. The optimal solution is the solution of the lights,
+///> combined as the sum of the solutions of the low and of the high lights,
+///> plus a combination of the null space saved in the mapped table.
+typedef struct
+{
+  ///> Array of solutions of every combination of the low lights.
+  uint32_t low[1 << N_TABLE_LOW];
+  ///> Array of solutions of every combination of the high lights.
+  uint32_t high[1 << (N_TABLE_SQUARES - N_TABLE_LOW)];
+  ///> Array of every combination of the null space basis.
+  uint32_t null[16];
+  ///> Mapped table of the null space combinations of the optimal solutions
+  ///> (4 bits per game status).
+  const uint8_t *combination;
+  GMappedFile *mapped;          ///< Mapped table file (NULL if not mapped).
+} SolverTable;
 
-extern unsigned int nrows, ncolumns, nsquares, level;
-extern int nmovements;
-extern unsigned int movement[N_MAX_SQUARES];
-extern uint64_t status, movements_array[N_MAX_SQUARES];
+///> Struct to define the filters of the generated games.
+typedef struct
+{
+  int nmovements;
+  ///< Number of movements of the optimal solution (-1 to not filter).
+  unsigned int unique;
+  ///< 1 to generate only games with a unique optimal solution.
+  unsigned int min_lights;      ///< Minimum number of lights.
+  unsigned int max_lights;      ///< Maximum number of lights.
+} GenerateFilter;
+
+///> Function called on every enumerated solution of a board with the board
+///> codifying the movements and their number. It returns 1 to continue the
+///> enumeration, 0 to stop it.
+typedef int (*SolverCallback) (const Board * solution,
+                               unsigned int nmovements, void *data);
+
+///> Struct to define a game.
+typedef struct
+{
+  Board status;                 ///< Current game status.
+  Board solution;               ///< Pressed squares of the optimal solution.
+  int nmovements;               ///< Movements number of the optimal solution.
+  unsigned int level;           ///< Game level.
+  SolverStats stats;            ///< Instrumentation counters of the last play.
+  uint64_t seed;                ///< Seed of the random game.
+  ///> Permutation of the squares to select distinct random movements.
+  uint16_t square[N_MAX_SQUARES];
+  SolverTable table;            ///< Optimal solutions table of the board size.
+  Solver solver;                ///< Solver data of the board size.
+} LightsOffGame;
+
+void board_write (FILE * file, const uint64_t * board, unsigned int nwords);
+int solver_stencil (const char *name);
+void solver_init_stencil (Solver * solver, unsigned int nrows,
+                          unsigned int ncolumns, unsigned int stencil);
+void solver_init (Solver * solver, unsigned int nrows, unsigned int ncolumns);
+const Solver *solver_open (const char *directory, unsigned int nrows,
+                           unsigned int ncolumns, unsigned int stencil,
+                           GMappedFile ** mapped);
+void solver_close (const Solver * solver, GMappedFile * mapped);
+int solver_table_open (SolverTable * table, const Solver * solver,
+                       const char *directory, int build);
+void solver_table_close (SolverTable * table);
+int solver_solve (const Solver * solver, const Board * status,
+                  Board * solution, SolverStats * stats);
+void play_slice (const Solver * solver, const uint64_t * boards,
+                 unsigned int n, int *results, uint64_t * solutions);
+int solver_minimize (const Solver * solver, Board * solution);
+unsigned int solver_optimal_number (const Solver * solver,
+                                    const Board * solution);
+long int solver_enumerate (const Solver * solver, const Board * status,
+                           int max_movements, SolverCallback callback,
+                           void *data);
+void play_batch (const Solver * solver, const uint64_t * boards,
+                 unsigned int n, int *results, uint64_t * solutions,
+                 SolverStats * stats, unsigned int nthreads);
+unsigned int generate_games (const Solver * solver, GameRand * rand,
+                             const GenerateFilter * filter, unsigned int n,
+                             uint64_t * boards, uint64_t * solutions,
+                             int *results, unsigned int nthreads);
+void game_init (LightsOffGame * game, unsigned int nrows,
+                unsigned int ncolumns);
+void game_rand_seed (GameRand * rand, uint64_t seed);
+void game_new_rand (LightsOffGame * game, GameRand * rand);
+void game_new_seed (LightsOffGame * game, uint64_t seed);
+void game_new (LightsOffGame * game);
+int play (LightsOffGame * game);
+
+/**
+ * Function to get the next pseudo-random number of a xoshiro256** generator.
+ *
+ * \return pseudo-random 64 bits number.
+ */
+static inline uint64_t
+game_rand_next (GameRand * rand)        ///< pseudo-random numbers generator.
+{
+  uint64_t *s, r, t;
+  s = rand->state;
+  r = s[1] * 5L;
+  r = ((r << 7) | (r >> 57)) * 9L;
+  t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = (s[3] << 45) | (s[3] >> 19);
+  return r;
+}
 
-void game_init ();
-void game_new ();
-int play ();
+/**
+ * Function to get an unbiased pseudo-random number in a range by a multiply
+ * and shift, rejecting the few biased products.
+ *
+ * \return pseudo-random number from 0 to n - 1.
+ */
+static inline unsigned int
+game_rand_range (GameRand * rand,       ///< pseudo-random numbers generator.
+                 unsigned int n)        ///< size of the range.
+{
+  uint64_t m;
+  uint32_t threshold;
+  m = (game_rand_next (rand) >> 32) * n;
+  if ((uint32_t) m < n)
+    {
+      threshold = -n % n;
+      while ((uint32_t) m < threshold)
+        m = (game_rand_next (rand) >> 32) * n;
+    }
+  return m >> 32;
+}
 
 /**
  * Function to set a square.
@@ -64,10 +283,247 @@ set (uint64_t * status,         ///< bits chain codifying the game status.
  * Function to do one movement.
  */
 static inline void
-move (uint64_t * status,        ///< bits chain codifying the game status.
+move (const Solver * solver,    ///< solver data.
+      uint64_t * status,        ///< bits chain codifying the game status.
       unsigned int type)        ///< type of movement.
 {
-  *status ^= movements_array[type];
+  *status ^= solver->movements_array[type];
+}
+
+/**
+ * Function to search the optimal play to elliminate the lights of a small
+ * board in the optimal solutions table.
+ *
+ * \return on succes: number of movements; on failure: -1.
+ */
+static inline int
+solver_table_solve (const SolverTable * table,  ///< optimal solutions table.
+                    const Solver * solver,      ///< solver data.
+                    uint64_t status,
+                    ///< bits chain codifying the game status.
+                    uint64_t * solution)
+                    ///< bits chain codifying the optimal movements.
+{
+  unsigned int i;
+  for (i = 0; i < solver->nparity; ++i)
+    if (__builtin_parityll (status & solver->parity_array[i]))
+      return -1;
+  *solution = table->low[status & ((1L << N_TABLE_LOW) - 1L)]
+    ^ table->high[status >> N_TABLE_LOW]
+    ^ table->null[(table->combination[status >> 1] >> ((status & 1L) << 2))
+                  & 15];
+  return __builtin_popcountll (*solution);
+}
+
+/**
+ * Function to clear a board.
+ */
+static inline void
+board_zero (Board * board,      ///< board.
+            unsigned int nwords)        ///< number of words.
+{
+  unsigned int i;
+  for (i = 0; i < nwords; ++i)
+    board->word[i] = 0L;
+}
+
+/**
+ * Function to check if a board is clear.
+ *
+ * \return 1 if all lights are off, 0 otherwise.
+ */
+static inline int
+board_is_zero (const Board * board,     ///< board.
+               unsigned int nwords)     ///< number of words.
+{
+  unsigned int i;
+  for (i = 0; i < nwords; ++i)
+    if (board->word[i])
+      return 0;
+  return 1;
+}
+
+/**
+ * Function to get a square of a board.
+ *
+ * \return 1 if the light is on, 0 otherwise.
+ */
+static inline int
+board_get (const Board * board, ///< board.
+           unsigned int square) ///< square index.
+{
+  return (board->word[square / N_WORD_SQUARES] >> (square % N_WORD_SQUARES))
+    & 1L;
+}
+
+/**
+ * Function to set a square of a board.
+ */
+static inline void
+board_set (Board * board,       ///< board.
+           unsigned int square) ///< square index.
+{
+  set (board->word + square / N_WORD_SQUARES, square % N_WORD_SQUARES);
+}
+
+/**
+ * Function to add a board to other.
+ */
+static inline void
+board_xor (Board * board,       ///< board.
+           const Board * other, ///< other board to add.
+           unsigned int nwords) ///< number of words.
+{
+  unsigned int i;
+  for (i = 0; i < nwords; ++i)
+    board->word[i] ^= other->word[i];
+}
+
+/**
+ * Function to count the lights of a board.
+ *
+ * \return number of lights on.
+ */
+static inline unsigned int
+board_count (const Board * board,       ///< board.
+             unsigned int nwords)       ///< number of words.
+{
+  unsigned int i, n;
+  for (i = n = 0; i < nwords; ++i)
+    n += __builtin_popcountll (board->word[i]);
+  return n;
+}
+
+/**
+ * Function to iterate over the lights of a board.
+ *
+ * \return next light after the given square, -1 if there are no more lights.
+ */
+static inline int
+board_next (const Board * board,        ///< board.
+            unsigned int nwords,        ///< number of words.
+            int square)         ///< square (-1 to get the first light).
+{
+  uint64_t w;
+  unsigned int i;
+  ++square;
+  i = square / N_WORD_SQUARES;
+  if (i >= nwords)
+    return -1;
+  w = board->word[i] & (~(uint64_t) 0 << (square % N_WORD_SQUARES));
+  while (!w)
+    {
+      if (++i == nwords)
+        return -1;
+      w = board->word[i];
+    }
+  return i * N_WORD_SQUARES + __builtin_ctzll (w);
+}
+
+/**
+ * Function to add other board to a board counting the lights of the result.
+ *
+ * \return number of lights on.
+ */
+static inline unsigned int
+board_xor_count (Board * board, ///< board.
+                 const Board * other,   ///< other board to add.
+                 unsigned int nwords)   ///< number of words.
+{
+  unsigned int i, n;
+  for (i = n = 0; i < nwords; ++i)
+    {
+      board->word[i] ^= other->word[i];
+      n += __builtin_popcountll (board->word[i]);
+    }
+  return n;
+}
+
+/**
+ * Function to do one movement on a board.
+ */
+static inline void
+board_move (const Solver * solver,      ///< solver data.
+            Board * board,      ///< board.
+            unsigned int type)  ///< type of movement.
+{
+  if (solver->nwords == 1)
+    move (solver, board->word, type);
+  else
+    board_xor (board, solver->movements_board + type, solver->nwords);
+}
+
+/**
+ * Function to set a square of a game.
+ */
+static inline void
+game_set (LightsOffGame * game, ///< game.
+          unsigned int square)  ///< square index.
+{
+  board_set (&game->status, square);
+}
+
+/**
+ * Function to do one movement on a game.
+ */
+static inline void
+game_move (LightsOffGame * game,        ///< game.
+           unsigned int type)   ///< type of movement.
+{
+  board_move (&game->solver, &game->status, type);
+}
+
+/**
+ * Function to check if a board can be solved: the lights have even parity on
+ * every parity mask (the board is orthogonal to the null space of the
+ * transposed movements matrix).
+ *
+ * \return 1 if the board can be solved, 0 otherwise.
+ */
+static inline int
+solver_is_solvable (const Solver * solver,      ///< solver data.
+                    const Board * status)
+                    ///< board codifying the game status.
+{
+  uint64_t p;
+  unsigned int i, j;
+  if (solver->nwords == 1)
+    {
+      for (i = 0; i < solver->nparity; ++i)
+        if (__builtin_parityll (status->word[0] & solver->parity_array[i]))
+          return 0;
+      return 1;
+    }
+  for (i = 0; i < solver->nparity; ++i)
+    {
+      for (p = 0L, j = 0; j < solver->nwords; ++j)
+        p ^= status->word[j] & solver->parity_board[i].word[j];
+      if (__builtin_parityll (p))
+        return 0;
+    }
+  return 1;
+}
+
+/**
+ * Function to check if a game can be solved.
+ *
+ * \return 1 if the game can be solved, 0 otherwise.
+ */
+static inline int
+game_is_solvable (const LightsOffGame * game)   ///< game.
+{
+  return solver_is_solvable (&game->solver, &game->status);
+}
+
+/**
+ * Function to check if a game is solved.
+ *
+ * \return 1 if all lights are off, 0 otherwise.
+ */
+static inline int
+game_is_solved (const LightsOffGame * game)     ///< game.
+{
+  return board_is_zero (&game->status, game->solver.nwords);
 }
 
 #endif
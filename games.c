@@ -0,0 +1,154 @@
+/*
+LightsOff:
+A clone of the Tim Horton's LightsOff program written in C, adding variable
+board sizes, undo and clear movements and a solver.
+
+Copyright 2016-2021, Javier Burguete Tolosa.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file games.c
+ * \brief Source file of the lights off games files.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2016-2021, Javier Burguete Tolosa.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <glib.h>
+#include "config.h"
+#include "game.h"
+#include "games.h"
+
+///> Size of the games files writing buffer.
+#define GAMES_BUFFER_SIZE (1 << 16)
+
+/**
+ * Function to open a games file writer and to write the header.
+ *
+ * \return 1 on succes, 0 on error.
+ */
+int
+games_writer_open (GamesWriter * writer,        ///< games file writer.
+                   const char *name,
+                   ///< name of the file (NULL to use the standard output).
+                   unsigned int nrows,  ///< rows number.
+                   unsigned int ncolumns,       ///< columns number.
+                   unsigned int stencil)        ///< neighbourhood.
+{
+  GamesHeader header;
+  if (name)
+    {
+      writer->file = fopen (name, "wb");
+      if (!writer->file)
+        return 0;
+    }
+  else
+    writer->file = stdout;
+  setvbuf (writer->file, NULL, _IOFBF, GAMES_BUFFER_SIZE);
+  writer->nwords = (nrows * ncolumns + 63) / 64;
+  memset (&header, 0, sizeof (GamesHeader));
+  header.magic = GAMES_MAGIC;
+  header.version = GAMES_VERSION;
+  header.nrows = nrows;
+  header.ncolumns = ncolumns;
+  header.stencil = stencil;
+  header.nwords = writer->nwords;
+  header.size = (2 * writer->nwords + 1) * sizeof (uint64_t);
+  if (fwrite (&header, sizeof (GamesHeader), 1, writer->file) != 1)
+    {
+      games_writer_close (writer);
+      return 0;
+    }
+  return 1;
+}
+
+/**
+ * Function to close a games file writer.
+ *
+ * \return 1 on succes, 0 on error.
+ */
+int
+games_writer_close (GamesWriter * writer)       ///< games file writer.
+{
+  if (writer->file == stdout)
+    return !fflush (stdout);
+  return !fclose (writer->file);
+}
+
+/**
+ * Function to map a games file read-only.
+ *
+ * \return 1 on succes, 0 if the file does not exist or it is not valid.
+ */
+int
+games_reader_open (GamesReader * reader,        ///< games file reader.
+                   const char *name)    ///< name of the file.
+{
+  const GamesHeader *header;
+  uint64_t length;
+  unsigned int size;
+  reader->mapped = g_mapped_file_new (name, FALSE, NULL);
+  if (!reader->mapped)
+    return 0;
+
+  // Checking the header
+  header = (const GamesHeader *) g_mapped_file_get_contents (reader->mapped);
+  length = g_mapped_file_get_length (reader->mapped);
+  if (length < sizeof (GamesHeader) || header->magic != GAMES_MAGIC
+      || header->version != GAMES_VERSION
+      || (header->stencil & ~SOLVER_STENCIL_TORUS) >= N_STENCILS
+      || header->nwords != (header->nrows * header->ncolumns + 63) / 64)
+    {
+      games_reader_close (reader);
+      return 0;
+    }
+  size = (2 * header->nwords + 1) * sizeof (uint64_t);
+  length -= sizeof (GamesHeader);
+  if (header->size != size || length % size)
+    {
+      games_reader_close (reader);
+      return 0;
+    }
+
+  // Pointing to the records without copying them
+  reader->records = (const uint64_t *) (header + 1);
+  reader->ngames = length / size;
+  reader->nrows = header->nrows;
+  reader->ncolumns = header->ncolumns;
+  reader->stencil = header->stencil;
+  reader->nwords = header->nwords;
+  return 1;
+}
+
+/**
+ * Function to close a games file reader.
+ */
+void
+games_reader_close (GamesReader * reader)       ///< games file reader.
+{
+  g_mapped_file_unref (reader->mapped);
+  reader->mapped = NULL;
+}
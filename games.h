@@ -0,0 +1,141 @@
+/*
+LightsOff:
+A clone of the Tim Horton's LightsOff program written in C, adding variable
+board sizes, undo and clear movements and a solver.
+
+Copyright 2016-2021, Javier Burguete Tolosa.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file games.h
+ * \brief Header file of the lights off games files.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2016-2021, Javier Burguete Tolosa.
+ */
+#ifndef GAMES__H
+#define GAMES__H 1
+
+#define GAMES_MAGIC 0x474F534CU ///< Magic number of the games files ("LSOG").
+#define GAMES_VERSION 2         ///< Version of the games files format.
+
+///> Struct to define the header of a games file. The header is followed by
+///> fixed width records of 2 * nwords + 1 words of 64 bits: the packed board,
+///> the packed optimal movements and the number of movements (-1 if the board
+///> can not be solved). The words are saved in the byte order of the machine
+///> (a different order is detected by the magic number). The number of records
+///> is given by the file length, so the files can be written as streams.
+typedef struct
+{
+  uint32_t magic;               ///< Magic number.
+  uint32_t version;             ///< Version of the file format.
+  uint32_t nrows;               ///< Rows number.
+  uint32_t ncolumns;            ///< Columns number.
+  uint32_t stencil;             ///< Neighbourhood of the movements.
+  uint32_t nwords;              ///< Number of words of a packed board.
+  uint32_t size;                ///< Size of a record in bytes.
+} __attribute__ ((aligned (64))) GamesHeader;
+
+///> Struct to define a games file writer.
+typedef struct
+{
+  FILE *file;                   ///< File.
+  unsigned int nwords;          ///< Number of words of a packed board.
+} GamesWriter;
+
+///> Struct to define a games file reader.
+typedef struct
+{
+  const uint64_t *records;      ///< Array of records.
+  GMappedFile *mapped;          ///< Mapped file.
+  uint64_t ngames;              ///< Number of games.
+  unsigned int nrows;           ///< Rows number.
+  unsigned int ncolumns;        ///< Columns number.
+  unsigned int stencil;         ///< Neighbourhood of the movements.
+  unsigned int nwords;          ///< Number of words of a packed board.
+} GamesReader;
+
+int games_writer_open (GamesWriter * writer, const char *name,
+                       unsigned int nrows, unsigned int ncolumns,
+                       unsigned int stencil);
+int games_writer_close (GamesWriter * writer);
+int games_reader_open (GamesReader * reader, const char *name);
+void games_reader_close (GamesReader * reader);
+
+/**
+ * Function to write a game in a games file.
+ *
+ * \return 1 on succes, 0 on error.
+ */
+static inline int
+games_writer_write (GamesWriter * writer,       ///< games file writer.
+                    const uint64_t * board,     ///< packed board.
+                    const uint64_t * solution,
+                    ///< packed optimal movements.
+                    int nmovements)     ///< number of movements.
+{
+  int64_t n;
+  n = nmovements;
+  return fwrite (board, sizeof (uint64_t), writer->nwords, writer->file)
+    == writer->nwords
+    && fwrite (solution, sizeof (uint64_t), writer->nwords, writer->file)
+    == writer->nwords && fwrite (&n, sizeof (int64_t), 1, writer->file) == 1;
+}
+
+/**
+ * Function to get the packed board of a game of a games file.
+ *
+ * \return packed board.
+ */
+static inline const uint64_t *
+games_reader_board (const GamesReader * reader, ///< games file reader.
+                    uint64_t i) ///< game number.
+{
+  return reader->records + i * (2 * reader->nwords + 1);
+}
+
+/**
+ * Function to get the packed optimal movements of a game of a games file.
+ *
+ * \return packed optimal movements.
+ */
+static inline const uint64_t *
+games_reader_solution (const GamesReader * reader,      ///< games file reader.
+                       uint64_t i)      ///< game number.
+{
+  return games_reader_board (reader, i) + reader->nwords;
+}
+
+/**
+ * Function to get the number of movements of a game of a games file.
+ *
+ * \return number of movements (-1 if the board can not be solved).
+ */
+static inline int
+games_reader_movements (const GamesReader * reader,     ///< games file reader.
+                        uint64_t i)     ///< game number.
+{
+  return (int) (int64_t) games_reader_board (reader, i)[2 * reader->nwords];
+}
+
+#endif
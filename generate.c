@@ -0,0 +1,220 @@
+/*
+LightsOff:
+A clone of the Tim Horton's LightsOff program written in C, adding variable
+board sizes, undo and clear movements and a solver.
+
+Copyright 2016-2021, Javier Burguete Tolosa.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file generate.c
+ * \brief Source file of the lights off bulk games generator.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2016-2021, Javier Burguete Tolosa.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <glib.h>
+#include "config.h"
+#include "game.h"
+#include "games.h"
+
+///> Number of games tried at once.
+#define BLOCK_SIZE (1 << 16)
+///> Maximum number of consecutive blocks without games passing the filters.
+#define MAX_EMPTY_BLOCKS 64
+///> Maximum doubling of the tried games while no game passes the filters.
+#define MAX_GROWTH 16
+
+/**
+ * Main function.
+ *
+ * \return 0 on succes, error code on error.
+ */
+int
+main (int argn,                 ///< arguments number.
+      char **argc)              ///< array of argument chains.
+{
+  GenerateFilter filter;
+  Solver *solver;
+  GamesWriter writer;
+  GameRand rand;
+  uint64_t *boards, *solutions;
+  int *results;
+  double min_density, max_density;
+  unsigned long int n, ngames, ntried, npassed, block;
+  unsigned int i, j, nthreads, nrows, ncolumns, seed, nempty, error;
+  int stencil;
+
+  // Reading the command line
+  nthreads = seed = 0;
+  stencil = SOLVER_STENCIL_PLUS;
+  filter.nmovements = -1;
+  filter.unique = 0;
+  min_density = 0.;
+  max_density = 1.;
+  for (; argn > 2; argn -= 2, argc += 2)
+    if (!strcmp (argc[1], "-t"))
+      nthreads = atoi (argc[2]);
+    else if (!strcmp (argc[1], "-s"))
+      seed = atoi (argc[2]);
+    else if (!strcmp (argc[1], "-n"))
+      stencil = solver_stencil (argc[2]);
+    else if (!strcmp (argc[1], "-m"))
+      filter.nmovements = atoi (argc[2]);
+    else if (!strcmp (argc[1], "-u"))
+      {
+        // Option without argument
+        filter.unique = 1;
+        ++argn;
+        --argc;
+      }
+    else if (!strcmp (argc[1], "-d") && argn > 3)
+      {
+        // Option with two arguments
+        min_density = atof (argc[2]);
+        max_density = atof (argc[3]);
+        --argn;
+        ++argc;
+      }
+    else
+      break;
+  if (argn < 4 || argn > 5)
+    {
+      fprintf (stderr, "Usage: lightsoff-generate [-t threads] [-s seed] "
+               "[-n neighbourhood] [-m movements] [-u] "
+               "[-d min_density max_density] rows columns number "
+               "[output_file]\n");
+      return 1;
+    }
+  nrows = atoi (argc[1]);
+  ncolumns = atoi (argc[2]);
+  n = strtoul (argc[3], NULL, 10);
+  if (nrows < 2 || nrows > N_MAX_ROWS || ncolumns < 2
+      || ncolumns > N_MAX_COLUMNS)
+    {
+      fprintf (stderr, "lightsoff-generate: bad board size (2x2 to %ux%u)\n",
+               N_MAX_ROWS, N_MAX_COLUMNS);
+      return 1;
+    }
+  if (stencil < 0)
+    {
+      fprintf (stderr, "lightsoff-generate: bad neighbourhood (plus, x, "
+               "square or knight, optionally followed by -torus)\n");
+      return 1;
+    }
+  if (filter.nmovements > (int) (nrows * ncolumns))
+    {
+      fprintf (stderr, "lightsoff-generate: bad number of movements\n");
+      return 1;
+    }
+  if (min_density < 0. || max_density > 1. || min_density > max_density)
+    {
+      fprintf (stderr, "lightsoff-generate: bad density (0 to 1)\n");
+      return 1;
+    }
+  filter.min_lights = (unsigned int) (min_density * nrows * ncolumns + 0.5);
+  filter.max_lights = (unsigned int) (max_density * nrows * ncolumns + 0.5);
+  if (!games_writer_open (&writer, argn == 5 ? argc[4] : NULL, nrows,
+                          ncolumns, stencil))
+    {
+      fprintf (stderr,
+               "lightsoff-generate: unable to open the output file\n");
+      return 1;
+    }
+
+  // Initing the solver and the pseudo-random numbers generator
+  solver = (Solver *) g_malloc (sizeof (Solver));
+  solver_init_stencil (solver, nrows, ncolumns, stencil);
+  game_rand_seed (&rand, seed);
+  if (solver->nnull > N_MAX_SEARCH)
+    {
+      if (filter.unique)
+        {
+          fprintf (stderr, "lightsoff-generate: null space of %u dimensions "
+                   "too large to check unique solutions\n", solver->nnull);
+          g_free (solver);
+          games_writer_close (&writer);
+          return 1;
+        }
+      fprintf (stderr, "lightsoff-generate: warning: null space of %u "
+               "dimensions, the solutions are minimized by descent and they "
+               "can be not optimal\n", solver->nnull);
+    }
+
+  // Generating the games by blocks
+  boards = (uint64_t *)
+    g_malloc (2 * BLOCK_SIZE * solver->nwords * sizeof (uint64_t));
+  solutions = boards + BLOCK_SIZE * solver->nwords;
+  results = (int *) g_malloc (BLOCK_SIZE * sizeof (int));
+  for (ngames = ntried = npassed = nempty = error = 0; !error && ngames < n;)
+    {
+      // Trying only the games expected to get the left games (a solve can
+      // search a large null space), growing the block while no game passes
+      block = MIN (n - ngames, BLOCK_SIZE);
+      if (npassed)
+        {
+          block = block * ntried / npassed;
+          block += block / 4 + 1;
+        }
+      else
+        block <<= MIN (nempty, MAX_GROWTH);
+      block = MIN (block, BLOCK_SIZE);
+      i = generate_games (solver, &rand, &filter, (unsigned int) block,
+                          boards, solutions, results, nthreads);
+      ntried += block;
+      npassed += i;
+      if (!i)
+        {
+          if (++nempty == MAX_EMPTY_BLOCKS)
+            {
+              fprintf (stderr, "lightsoff-generate: no games passing the "
+                       "filters\n");
+              break;
+            }
+          continue;
+        }
+      nempty = 0;
+      i = (unsigned int) MIN ((unsigned long int) i, n - ngames);
+      for (j = 0; j < i; ++j)
+        if (!games_writer_write (&writer, boards + j * solver->nwords,
+                                 solutions + j * solver->nwords, results[j]))
+          {
+            fprintf (stderr, "lightsoff-generate: unable to write\n");
+            error = 1;
+            break;
+          }
+      ngames += j;
+    }
+
+  // Closing
+  g_free (results);
+  g_free (boards);
+  g_free (solver);
+  if (!games_writer_close (&writer) || error || ngames < n)
+    return 2;
+  return 0;
+}
@@ -33,13 +33,16 @@ OF SUCH DAMAGE.
  * \author Javier Burguete Tolosa.
  * \copyright Copyright 2016-2021, Javier Burguete Tolosa.
  */
+#include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <libintl.h>
 #include <glib.h>
 #include <gtk/gtk.h>
 #include "config.h"
 #include "game.h"
+#include "games.h"
 #include "interface.h"
 
 ///> Type of buttons theme.
@@ -52,6 +55,23 @@ enum WindowTheme
 ///> Number of button themes.
 #define N_THEMES (WINDOW_THEME_FACES + 1)
 
+///> Size of the movements history ring buffer (older movements are dropped).
+#define HISTORY_SIZE (1 << 16)
+
+///> Struct to define the data of a solve on a worker thread. The solver data
+///> and the game status are copied, so the game can change while solving.
+typedef struct
+{
+  Solver solver;                ///< Solver data.
+  Board status;                 ///< Game status.
+  Board solution;
+  ///< Optimal movements (of the previous status updating a solution).
+  int nmovements;               ///< Number of movements.
+  int square;
+  ///< Square of the movement updating a solution, -1 to solve the status.
+  unsigned int hint;            ///< 1 on hint updates, 0 on solves.
+} WindowSolve;
+
 ///> Theme images for the light buttons.
 const char *light_images[N_THEMES] = {
   "media-playback-stop",
@@ -70,18 +90,37 @@ unsigned int window_columns = DEFAULT_COLUMNS;
 ///< Number of window columns.
 unsigned int window_squares = 0;
 ///< Number of window squares.
+unsigned int window_level = DEFAULT_LEVEL;
+///< Game level.
 unsigned int window_input = 0;
 ///< New games input method: 0 level-based random, 1 user set.
+unsigned int window_hint = 0;
+///< Hint mode: 1 to show the optimal solution after every movement.
 unsigned int window_theme = WINDOW_THEME_GEOMETRIC;
 ///< Light buttons theme.
 unsigned int array_ids[N_MAX_SQUARES];
 ///< Array of button signal identifiers.
 unsigned int window_movements;
 ///< Number of user movements.
-GList *list_movements = NULL;
-///< List of user movements.
-GList *list_undo = NULL;
-///< List of undo movements.
+uint16_t history[HISTORY_SIZE];
+///< Ring buffer of the user movements history.
+unsigned int history_first = 0;
+///< Position of the first movement in the history.
+unsigned int history_cursor = 0;
+///< Position after the last done movement in the history.
+unsigned int history_last = 0;
+///< Position after the last undone movement in the history.
+Board window_pressed;
+///< Squares pressed an odd number of times by the user movements.
+Board window_lights;
+///< Lights drawn on the light buttons.
+Board window_marks;
+///< Squares of the optimal solution drawn on the light buttons.
+LightsOffGame game;             ///< Game.
+GCancellable *solve_cancellable = NULL;
+///< GCancellable of the solve on a worker thread.
+unsigned int window_solved = 0;
+///< 1 if the game solution is the optimal solution of the game status.
 
 GtkImage *image;                ///< GtkImage to draw the logo.
 GtkSpinButton *spin_rows;       ///< GtkSpinButton to set the rows number.
@@ -89,10 +128,15 @@ GtkSpinButton *spin_columns;    ///< GtkSpinButton to set the columns number.
 GtkSpinButton *spin_level;      ///< GtkSpinButton to set the game level.
 GtkLabel *label_movements;      ///< Label showing the number of user movements.
 GtkCheckButton *button_input;   ///< Button to set the new games input method.
+GtkCheckButton *button_hint;    ///< Button to set the hint mode.
 GtkToggleButton **array_buttons = NULL; ///< Array of light buttons.
-GtkImage **array_images = NULL; ///< Array of light images.
-GtkImage **array_solutions = NULL;      ///< Array of solution images.
+GtkImage **array_images = NULL;
+///< Array of light images, reused on every redraw.
+GtkImage **array_solutions = NULL;
+///< Array of solution images, reused on every redraw.
 GtkButton *button_new;          ///< New game tool button.
+GtkButton *button_open;         ///< Open game tool button.
+GtkButton *button_save;         ///< Save game tool button.
 GtkButton *button_options;      ///< Game options tool button.
 GtkButton *button_clear;        ///< Clear game tool button.
 GtkButton *button_undo;         ///< Undo last movement tool button.
@@ -103,44 +147,28 @@ GtkGrid *grid;                  ///< Light buttons grid.
 GtkWindow *window;              ///< Main window.
 GtkApplication *application;    ///< Application.
 
-/**
- * Function to free to undo movements list.
- */
-static void
-window_destroy_undo ()
-{
-  GList *list;
-#if DEBUG
-  fprintf (stderr, "window_destroy_undo: start\n");
-#endif
-  for (list = list_undo; list; list = list->next)
-    free (list->data);
-  g_list_free (list_undo);
-  list_undo = NULL;
-#if DEBUG
-  fprintf (stderr, "window_destroy_undo: end\n");
-#endif
-}
-
 /**
  * Function to free memory assigned by the main window.
  */
 void
 window_destroy ()
 {
-  GList *list;
   unsigned int i;
 #if DEBUG
   fprintf (stderr, "window_destroy: start\n");
 #endif
   for (i = 0; i < window_squares; ++i)
-    gtk_grid_remove (grid, GTK_WIDGET (array_buttons[i]));
+    {
+      gtk_grid_remove (grid, GTK_WIDGET (array_buttons[i]));
+      g_object_unref (array_images[i]);
+      g_object_unref (array_solutions[i]);
+    }
   free (array_buttons);
-  window_destroy_undo ();
-  for (list = list_movements; list; list = list->next)
-    free (list->data);
-  g_list_free (list_movements);
-  list_movements = NULL;
+  free (array_images);
+  free (array_solutions);
+  array_images = array_solutions = NULL;
+  history_first = history_cursor = history_last = 0;
+  board_zero (&window_pressed, N_MAX_WORDS);
 #if DEBUG
   fprintf (stderr, "window_destroy: end\n");
 #endif
@@ -159,58 +187,245 @@ window_update ()
   gtk_widget_show_all (GTK_WIDGET (grid));
 #endif
   gtk_widget_set_sensitive (GTK_WIDGET (button_clear), window_movements);
-  gtk_widget_set_sensitive (GTK_WIDGET (button_undo), window_movements);
-  gtk_widget_set_sensitive (GTK_WIDGET (button_redo), (size_t) list_undo);
+  gtk_widget_set_sensitive (GTK_WIDGET (button_undo),
+                            history_cursor != history_first);
+  gtk_widget_set_sensitive (GTK_WIDGET (button_redo),
+                            history_cursor != history_last);
 #if DEBUG
   fprintf (stderr, "window_update: end\n");
 #endif
 }
 
 /**
- * Function to set the light buttons.
+ * Function to set the image of a light button.
  */
 static void
-window_set ()
+window_child (GtkToggleButton * button, ///< light button.
+              GtkImage * image) ///< image (NULL to remove the image).
 {
-  char label[64];
-  GtkToggleButton *button;
-  GtkImage *image;
 #if !GTK4
-  GList *child;
-#endif
-  unsigned int i, id;
-#if DEBUG
-  fprintf (stderr, "window_set: start\n");
+  GtkWidget *child;
+  child = gtk_bin_get_child (GTK_BIN (button));
+  if (child)
+    gtk_container_remove (GTK_CONTAINER (button), child);
+  if (image)
+    gtk_container_add (GTK_CONTAINER (button), GTK_WIDGET (image));
+#else
+  gtk_button_set_child (GTK_BUTTON (button), GTK_WIDGET (image));
 #endif
+}
+
+/**
+ * Function to create the light and solution images of every light button for
+ * the current theme. The images are reused on every redraw.
+ */
+static void
+window_images ()
+{
+  unsigned int i;
   for (i = 0; i < window_squares; ++i)
     {
-      button = array_buttons[i];
-      id = array_ids[i];
-#if !GTK4
-      child = gtk_container_get_children (GTK_CONTAINER (button));
-      if (child)
-        gtk_widget_destroy (GTK_WIDGET (child->data));
-#endif
-      g_signal_handler_block (button, id);
-      if (status & (1L << i))
+      if (array_images[i])
         {
-          gtk_toggle_button_set_active (button, 1);
-          image = (GtkImage *)
-            image_new_from_icon_name (light_images[window_theme]);
-        }
-      else
-        {
-          gtk_toggle_button_set_active (button, 0);
-          image = NULL;
+          window_child (array_buttons[i], NULL);
+          g_object_unref (array_images[i]);
+          g_object_unref (array_solutions[i]);
         }
+      array_images[i] = (GtkImage *)
+        image_new_from_icon_name (light_images[window_theme]);
+      array_solutions[i] = (GtkImage *)
+        image_new_from_icon_name (solution_images[window_theme]);
+      g_object_ref_sink (array_images[i]);
+      g_object_ref_sink (array_solutions[i]);
 #if !GTK4
-      if (image)
-        gtk_container_add (GTK_CONTAINER (button), GTK_WIDGET (image));
-#else
-      gtk_button_set_child (GTK_BUTTON (button), GTK_WIDGET (image));
+      gtk_widget_show (GTK_WIDGET (array_images[i]));
+      gtk_widget_show (GTK_WIDGET (array_solutions[i]));
+#endif
+    }
+
+  // Every image is removed, so the buttons are redrawn on the next update
+  board_zero (&window_lights, N_MAX_WORDS);
+  board_zero (&window_marks, N_MAX_WORDS);
+}
+
+/**
+ * Function to draw the lights and the marks of the optimal solution. Only
+ * the light buttons changed from the last draw are updated.
+ */
+static void
+window_draw (const Board * marks)       ///< squares to mark.
+{
+  Board changed;
+  GtkToggleButton *button;
+  GtkImage *image;
+  unsigned int j, light, mark, nwords;
+  int i;
+  nwords = game.solver.nwords;
+  for (j = 0; j < nwords; ++j)
+    changed.word[j] = (game.status.word[j] ^ window_lights.word[j])
+      | (marks->word[j] ^ window_marks.word[j]);
+  for (i = board_next (&changed, nwords, -1); i >= 0;
+       i = board_next (&changed, nwords, i))
+    {
+      button = array_buttons[i];
+      light = board_get (&game.status, i);
+      mark = board_get (marks, i);
+      g_signal_handler_block (button, array_ids[i]);
+      gtk_toggle_button_set_active (button, light);
+      g_signal_handler_unblock (button, array_ids[i]);
+      if (mark)
+        image = array_solutions[i];
+      else if (light)
+        image = array_images[i];
+      else
+        image = NULL;
+      window_child (button, image);
+    }
+  window_lights = game.status;
+  window_marks = *marks;
+}
+
+/**
+ * Function to cancel the solve on a worker thread.
+ */
+static void
+window_cancel ()
+{
+  if (!solve_cancellable)
+    return;
+  g_cancellable_cancel (solve_cancellable);
+  g_object_unref (solve_cancellable);
+  solve_cancellable = NULL;
+}
+
+/**
+ * Function to solve the game on a worker thread.
+ */
+static void
+window_solve_thread (GTask * task,      ///< GTask.
+                     gpointer source,   ///< source object (unused).
+                     gpointer task_data,        ///< WindowSolve data.
+                     GCancellable * cancellable)        ///< GCancellable.
+{
+  WindowSolve *data;
+  data = (WindowSolve *) task_data;
+  if (g_task_return_error_if_cancelled (task))
+    return;
+  // Updating the optimal solution of the previous status after a movement
+  // (a movement is undone pressing again the square) or solving the status
+  if (data->square < 0)
+    data->nmovements = solver_solve (&data->solver, &data->status,
+                                     &data->solution, NULL);
+  else if (data->nmovements >= 0)
+    {
+      board_set (&data->solution, data->square);
+      data->nmovements = solver_minimize (&data->solver, &data->solution);
+    }
+  g_task_return_boolean (task, 1);
+}
+
+/**
+ * Function to mark the optimal solution found on a worker thread.
+ */
+static void
+window_solve_ready (GObject * source,   ///< source object (unused).
+                    GAsyncResult * result,      ///< GTask.
+                    gpointer user_data) ///< user data (unused).
+{
+  GtkMessageDialog *dialog;
+  WindowSolve *data;
+#if DEBUG
+  fprintf (stderr, "window_solve_ready: start\n");
 #endif
-      g_signal_handler_unblock (button, id);
+  // Checking if the solve was cancelled by a game change
+  if (!g_task_propagate_boolean (G_TASK (result), NULL))
+    return;
+
+  data = (WindowSolve *) g_task_get_task_data (G_TASK (result));
+  game.nmovements = data->nmovements;
+  if (game.nmovements >= 0)
+    game.solution = data->solution;
+  else
+    board_zero (&game.solution, game.solver.nwords);
+  window_solved = 1;
+  window_draw (&game.solution);
+  if (game.nmovements < 0 && !data->hint)
+    {
+      dialog = (GtkMessageDialog *)
+        gtk_message_dialog_new (window,
+                                GTK_DIALOG_MODAL,
+                                GTK_MESSAGE_INFO,
+                                GTK_BUTTONS_OK,
+                                "%s", _("Unable to find a solution"));
+      gtk_window_set_title (GTK_WINDOW (dialog), _("Sorry!"));
+      g_signal_connect_swapped (dialog, "response",
+                                G_CALLBACK (gtk_window_destroy),
+                                GTK_WINDOW (dialog));
+      widget_show (GTK_WIDGET (dialog));
     }
+#if DEBUG
+  fprintf (stderr, "window_solve_ready: end\n");
+#endif
+}
+
+/**
+ * Function to search the optimal solution on a worker thread, so the window
+ * does not freeze on large boards. A change of the game cancels the search.
+ */
+static void
+window_search (int square,
+               ///< square of the last movement to update the optimal solution
+               ///< of the previous status, -1 to solve the game status.
+               unsigned int hint)       ///< 1 on hint updates, 0 on solves.
+{
+  WindowSolve *data;
+  GTask *task;
+  window_cancel ();
+  solve_cancellable = g_cancellable_new ();
+  data = (WindowSolve *) g_malloc (sizeof (WindowSolve));
+  data->solver = game.solver;
+  data->status = game.status;
+  data->solution = game.solution;
+  data->nmovements = game.nmovements;
+  data->square = square;
+  data->hint = hint;
+  task = g_task_new (NULL, solve_cancellable, window_solve_ready, NULL);
+  g_task_set_task_data (task, data, g_free);
+  g_task_set_return_on_cancel (task, 1);
+  g_task_run_in_thread (task, window_solve_thread);
+  g_object_unref (task);
+}
+
+/**
+ * Function to update the hints after a change of the game. A movement updates
+ * the optimal solution of the previous status if it is known, other changes
+ * solve the game status.
+ */
+static void
+window_hint_update (int square)
+                    ///< square of the movement, -1 on other game changes.
+{
+  if (!window_solved)
+    square = -1;
+  window_solved = 0;
+  if (window_hint)
+    window_search (square, 1);
+}
+
+/**
+ * Function to set the light buttons.
+ */
+static void
+window_set ()
+{
+  char label[64];
+  Board marks;
+#if DEBUG
+  fprintf (stderr, "window_set: start\n");
+#endif
+  window_cancel ();
+  board_zero (&marks, game.solver.nwords);
+  window_draw (&marks);
   snprintf (label, 64, _("Number of movements: %u"), window_movements);
   gtk_label_set_text (label_movements, label);
   window_update ();
@@ -219,6 +434,16 @@ window_set ()
 #endif
 }
 
+/**
+ * Function to flag the unsolvable games.
+ */
+static inline void
+window_check ()
+{
+  if (!game_is_solvable (&game))
+    gtk_label_set_text (label_movements, _("Unsolvable game"));
+}
+
 /**
  * Function to set a square.
  */
@@ -230,8 +455,10 @@ window_toggle (GtkToggleButton * button)        ///< button to set.
   fprintf (stderr, "window_toggle: start\n");
 #endif
   for (i = 0; button != array_buttons[i]; ++i);
-  set (&status, i);
+  game_set (&game, i);
   window_set ();
+  window_hint_update (-1);
+  window_check ();
 #if DEBUG
   fprintf (stderr, "window_toggle: end\n");
 #endif
@@ -244,20 +471,21 @@ static void
 window_move (GtkToggleButton * button)  ///< button to move.
 {
   GtkMessageDialog *dialog;
-  unsigned int *data;
   unsigned int i;
 #if DEBUG
   fprintf (stderr, "window_move: start\n");
 #endif
   for (i = 0; button != array_buttons[i]; ++i);
-  move (&status, i);
-  window_destroy_undo ();
-  data = (unsigned int *) malloc (sizeof (unsigned int));
-  *data = i;
-  list_movements = g_list_prepend (list_movements, data);
+  game_move (&game, i);
+  board_set (&window_pressed, i);
+  history[history_cursor++ % HISTORY_SIZE] = i;
+  history_last = history_cursor;
+  if (history_cursor - history_first > HISTORY_SIZE)
+    ++history_first;
   ++window_movements;
   window_set ();
-  if (!status)
+  window_hint_update (i);
+  if (game_is_solved (&game))
     {
       dialog = (GtkMessageDialog *)
         gtk_message_dialog_new (window,
@@ -283,61 +511,62 @@ window_move (GtkToggleButton * button)  ///< button to move.
 static void
 window_undo ()
 {
-  unsigned int *data;
   unsigned int i;
 #if DEBUG
   fprintf (stderr, "window_undo: start\n");
 #endif
-  i = *(unsigned int *) (list_movements->data);
-  move (&status, i);
-  data = (unsigned int *) malloc (sizeof (unsigned int));
-  *data = i;
-  list_undo = g_list_prepend (list_undo, data);
-  free (list_movements->data);
-  list_movements = list_movements->next;
+  i = history[--history_cursor % HISTORY_SIZE];
+  game_move (&game, i);
+  board_set (&window_pressed, i);
   --window_movements;
   window_set ();
+  window_hint_update (i);
 #if DEBUG
   fprintf (stderr, "window_undo: end\n");
 #endif
 }
 
 /**
- * Function to clear all user movements.
+ * Function to clear all user movements. The movements commute and a pair of
+ * equal movements cancel, so only the squares pressed an odd number of times
+ * are pressed again and the buttons are set once.
  */
 static void
 window_clear ()
 {
+  int i;
 #if DEBUG
   fprintf (stderr, "window_clear: start\n");
 #endif
-  while (window_movements)
-    window_undo ();
+  for (i = board_next (&window_pressed, game.solver.nwords, -1); i >= 0;
+       i = board_next (&window_pressed, game.solver.nwords, i))
+    game_move (&game, i);
+  board_zero (&window_pressed, game.solver.nwords);
+  history_cursor = history_first;
+  window_movements = 0;
+  window_set ();
+  window_hint_update (-1);
 #if DEBUG
   fprintf (stderr, "window_clear: end\n");
 #endif
 }
 
 /**
- * Function to undo an user movement.
+ * Function to redo an user movement.
  */
 static void
 window_redo ()
 {
-  unsigned int *data;
   unsigned int i;
 #if DEBUG
   fprintf (stderr, "window_redo: start\n");
 #endif
-  data = (unsigned int *) malloc (sizeof (unsigned int));
-  i = *(unsigned int *) (list_undo->data);
-  *data = i;
-  move (&status, i);
-  list_movements = g_list_prepend (list_movements, data);
+  i = history[history_cursor++ % HISTORY_SIZE];
+  game_move (&game, i);
+  board_set (&window_pressed, i);
   ++window_movements;
-  free (list_undo->data);
-  list_undo = g_list_delete_link (list_undo, list_undo);
   window_set ();
+  window_hint_update (i);
 #if DEBUG
   fprintf (stderr, "window_redo: end\n");
 #endif
@@ -351,6 +580,8 @@ window_custom ()
 {
   GtkWidget *widget[] = {
     GTK_WIDGET (button_new),
+    GTK_WIDGET (button_open),
+    GTK_WIDGET (button_save),
     GTK_WIDGET (button_options),
     GTK_WIDGET (button_clear),
     GTK_WIDGET (button_undo),
@@ -360,7 +591,7 @@ window_custom ()
   GtkMessageDialog *dialog;
   GMainLoop *loop;
   unsigned int i;
-  for (i = 0; i < 6; ++i)
+  for (i = 0; i < 8; ++i)
     gtk_widget_set_sensitive (widget[i], 0);
   for (i = 0; i < window_squares; ++i)
     {
@@ -393,35 +624,33 @@ window_custom ()
       array_ids[i] = g_signal_connect (array_buttons[i], "clicked",
                                        G_CALLBACK (window_move), NULL);
     }
-  for (i = 0; i < 6; ++i)
+  for (i = 0; i < 8; ++i)
     gtk_widget_set_sensitive (widget[i], 1);
   window_update ();
+  window_check ();
 }
 
 /**
- * Function to do a new game.
+ * Function to create the light buttons of the game.
  */
 static void
-window_new_game ()
+window_board ()
 {
   unsigned int i, j, k;
 #if DEBUG
-  fprintf (stderr, "window_new_game: start\n");
+  fprintf (stderr, "window_board: start\n");
 #endif
-  window_destroy ();
-  nrows = window_rows;
-  ncolumns = window_columns;
-  if (window_input)
-    game_init ();
-  else
-    game_new ();
   array_buttons = (GtkToggleButton **)
-    malloc (nsquares * sizeof (GtkToggleButton *));
+    malloc (game.solver.nsquares * sizeof (GtkToggleButton *));
+  array_images = (GtkImage **)
+    calloc (game.solver.nsquares, sizeof (GtkImage *));
+  array_solutions = (GtkImage **)
+    calloc (game.solver.nsquares, sizeof (GtkImage *));
   for (i = k = 0; i < window_rows; ++i)
     for (j = 0; j < window_columns; ++j, ++k)
       {
 #if DEBUG
-        fprintf (stderr, "window_new_game: i=%u j=%u k=%u\n", i, j, k);
+        fprintf (stderr, "window_board: i=%u j=%u k=%u\n", i, j, k);
 #endif
         array_buttons[k] = (GtkToggleButton *) gtk_toggle_button_new ();
         gtk_widget_set_hexpand (GTK_WIDGET (array_buttons[k]), 1);
@@ -432,7 +661,29 @@ window_new_game ()
       }
   window_squares = k;
   window_movements = 0;
+  window_images ();
   window_set ();
+#if DEBUG
+  fprintf (stderr, "window_board: end\n");
+#endif
+}
+
+/**
+ * Function to do a new game.
+ */
+static void
+window_new_game ()
+{
+#if DEBUG
+  fprintf (stderr, "window_new_game: start\n");
+#endif
+  window_destroy ();
+  game_init (&game, window_rows, window_columns);
+  game.level = window_level;
+  if (!window_input)
+    game_new (&game);
+  window_board ();
+  window_hint_update (-1);
   if (window_input)
     window_custom ();
 #if DEBUG
@@ -440,6 +691,152 @@ window_new_game ()
 #endif
 }
 
+/**
+ * Function to show an error message.
+ */
+static void
+window_error (const char *message)      ///< error message.
+{
+  GtkMessageDialog *dialog;
+  dialog = (GtkMessageDialog *)
+    gtk_message_dialog_new (window,
+                            GTK_DIALOG_MODAL,
+                            GTK_MESSAGE_ERROR,
+                            GTK_BUTTONS_OK, "%s", message);
+  gtk_window_set_title (GTK_WINDOW (dialog), _("Error!"));
+  g_signal_connect_swapped (dialog, "response",
+                            G_CALLBACK (gtk_window_destroy),
+                            GTK_WINDOW (dialog));
+  widget_show (GTK_WIDGET (dialog));
+}
+
+/**
+ * Function to close the open game dialog, opening the first game of the file.
+ */
+static void
+window_open_close (GtkDialog * dlg,     ///< open game GtkDialog.
+                   int response_id)     ///< response identifier.
+{
+  GamesReader reader;
+  GFile *file;
+  char *name;
+  int ok;
+  if (response_id == GTK_RESPONSE_ACCEPT)
+    {
+      file = gtk_file_chooser_get_file (GTK_FILE_CHOOSER (dlg));
+      name = g_file_get_path (file);
+      ok = games_reader_open (&reader, name);
+      if (ok)
+        {
+          if (reader.ngames && reader.stencil == SOLVER_STENCIL_PLUS
+              && reader.nrows >= 2 && reader.nrows <= N_MAX_ROWS
+              && reader.ncolumns >= 2 && reader.ncolumns <= N_MAX_COLUMNS)
+            {
+              window_rows = reader.nrows;
+              window_columns = reader.ncolumns;
+              window_destroy ();
+              game_init (&game, window_rows, window_columns);
+              memcpy (game.status.word, games_reader_board (&reader, 0),
+                      reader.nwords * sizeof (uint64_t));
+              if (game.solver.nsquares % N_WORD_SQUARES)
+                game.status.word[reader.nwords - 1]
+                  &= (1L << (game.solver.nsquares % N_WORD_SQUARES)) - 1L;
+              window_board ();
+              window_check ();
+              window_hint_update (-1);
+            }
+          else
+            ok = 0;
+          games_reader_close (&reader);
+        }
+      g_free (name);
+      g_object_unref (file);
+      if (!ok)
+        window_error (_("Unable to open the game"));
+    }
+#if !GTK4
+  gtk_widget_destroy (GTK_WIDGET (dlg));
+#else
+  gtk_window_destroy (GTK_WINDOW (dlg));
+#endif
+}
+
+/**
+ * Function to open a game from a games file.
+ */
+static void
+window_open ()
+{
+  GtkDialog *dialog;
+  dialog = (GtkDialog *)
+    gtk_file_chooser_dialog_new (_("Open game"),
+                                 window,
+                                 GTK_FILE_CHOOSER_ACTION_OPEN,
+                                 _("_Open"), GTK_RESPONSE_ACCEPT,
+                                 _("_Cancel"), GTK_RESPONSE_CANCEL, NULL);
+  gtk_window_set_modal (GTK_WINDOW (dialog), 1);
+  g_signal_connect (dialog, "response", G_CALLBACK (window_open_close), NULL);
+  widget_show (GTK_WIDGET (dialog));
+}
+
+/**
+ * Function to close the save game dialog, saving the game status with its
+ * optimal solution.
+ */
+static void
+window_save_close (GtkDialog * dlg,     ///< save game GtkDialog.
+                   int response_id)     ///< response identifier.
+{
+  GamesWriter writer;
+  Board solution;
+  GFile *file;
+  char *name;
+  int n, ok;
+  if (response_id == GTK_RESPONSE_ACCEPT)
+    {
+      file = gtk_file_chooser_get_file (GTK_FILE_CHOOSER (dlg));
+      name = g_file_get_path (file);
+      n = solver_solve (&game.solver, &game.status, &solution, NULL);
+      if (n < 0)
+        board_zero (&solution, game.solver.nwords);
+      ok = games_writer_open (&writer, name, game.solver.nrows,
+                              game.solver.ncolumns, game.solver.stencil);
+      if (ok)
+        {
+          ok = games_writer_write (&writer, game.status.word, solution.word,
+                                   n);
+          ok = games_writer_close (&writer) && ok;
+        }
+      g_free (name);
+      g_object_unref (file);
+      if (!ok)
+        window_error (_("Unable to save the game"));
+    }
+#if !GTK4
+  gtk_widget_destroy (GTK_WIDGET (dlg));
+#else
+  gtk_window_destroy (GTK_WINDOW (dlg));
+#endif
+}
+
+/**
+ * Function to save the game in a games file.
+ */
+static void
+window_save ()
+{
+  GtkDialog *dialog;
+  dialog = (GtkDialog *)
+    gtk_file_chooser_dialog_new (_("Save game"),
+                                 window,
+                                 GTK_FILE_CHOOSER_ACTION_SAVE,
+                                 _("_Save"), GTK_RESPONSE_ACCEPT,
+                                 _("_Cancel"), GTK_RESPONSE_CANCEL, NULL);
+  gtk_window_set_modal (GTK_WINDOW (dialog), 1);
+  g_signal_connect (dialog, "response", G_CALLBACK (window_save_close), NULL);
+  widget_show (GTK_WIDGET (dialog));
+}
+
 /**
  * Function to update the options dialog properties.
  */
@@ -461,13 +858,22 @@ static void
 window_options_close (GtkDialog * dlg,  ///< options GtkDialog.
                       int response_id)  ///< response identifier.
 {
+  unsigned int theme;
   if (response_id == GTK_RESPONSE_OK)
     {
       window_rows = gtk_spin_button_get_value_as_int (spin_rows);
       window_columns = gtk_spin_button_get_value_as_int (spin_columns);
-      level = gtk_spin_button_get_value_as_int (spin_level);
+      window_level = gtk_spin_button_get_value_as_int (spin_level);
       window_input = gtk_check_button_get_active (button_input);
-      window_theme = gtk_combo_box_get_active (GTK_COMBO_BOX (combo_theme));
+      theme = gtk_combo_box_get_active (GTK_COMBO_BOX (combo_theme));
+      if (theme != window_theme)
+        {
+          window_theme = theme;
+          window_images ();
+        }
+      window_hint = gtk_check_button_get_active (button_hint);
+      window_set ();
+      window_hint_update (-1);
     }
 #if !GTK4
   gtk_widget_destroy (GTK_WIDGET (dlg));
@@ -526,14 +932,18 @@ window_options ()
   gtk_grid_attach (grid, GTK_WIDGET (button_input), 0, 3, 2, 1);
   g_signal_connect (button_input, "toggled",
                     G_CALLBACK (window_options_update), NULL);
+  button_hint = (GtkCheckButton *)
+    gtk_check_button_new_with_mnemonic (_("Show _hints"));
+  gtk_grid_attach (grid, GTK_WIDGET (button_hint), 0, 5, 2, 1);
   combo_theme = (GtkComboBoxText *) gtk_combo_box_text_new ();
   for (i = 0; i < N_THEMES; ++i)
     gtk_combo_box_text_append_text (combo_theme, window_themes[i]);
   gtk_grid_attach (grid, GTK_WIDGET (combo_theme), 1, 4, 1, 1);
   gtk_spin_button_set_value (spin_rows, window_rows);
   gtk_spin_button_set_value (spin_columns, window_columns);
-  gtk_spin_button_set_value (spin_level, level);
+  gtk_spin_button_set_value (spin_level, window_level);
   gtk_check_button_set_active (button_input, window_input);
+  gtk_check_button_set_active (button_hint, window_hint);
   gtk_combo_box_set_active (GTK_COMBO_BOX (combo_theme), window_theme);
   g_signal_connect (dialog, "response", G_CALLBACK (window_options_close),
                     NULL);
@@ -541,51 +951,15 @@ window_options ()
 }
 
 /**
- * Function to print the optimal solution.
+ * Function to show the optimal solution.
  */
 static void
 window_solve ()
 {
-  GtkMessageDialog *dialog;
-  GtkToggleButton *button;
-  GtkImage *image;
-#if !GTK4
-  GList *list;
-#endif
-  int i;
 #if DEBUG
   fprintf (stderr, "window_solve: start\n");
 #endif
-  nmovements = play ();
-  for (i = 0; i < nmovements; ++i)
-    {
-      button = array_buttons[movement[i]];
-#if !GTK4
-      list = gtk_container_get_children (GTK_CONTAINER (button));
-      if (list)
-        gtk_widget_destroy (GTK_WIDGET (list->data));
-#endif
-      image = (GtkImage *)
-        image_new_from_icon_name (solution_images[window_theme]);
-#if !GTK4
-      gtk_widget_show (GTK_WIDGET (image));
-#endif
-      gtk_button_set_child (GTK_BUTTON (button), GTK_WIDGET (image));
-    }
-  if (nmovements < 0)
-    {
-      dialog = (GtkMessageDialog *)
-        gtk_message_dialog_new (window,
-                                GTK_DIALOG_MODAL,
-                                GTK_MESSAGE_INFO,
-                                GTK_BUTTONS_OK,
-                                "%s", _("Unable to find a solution"));
-      gtk_window_set_title (GTK_WINDOW (dialog), _("Sorry!"));
-      g_signal_connect_swapped (dialog, "response",
-                                G_CALLBACK (gtk_window_destroy),
-                                GTK_WINDOW (dialog));
-      widget_show (GTK_WIDGET (dialog));
-    }
+  window_search (-1, 0);
 #if DEBUG
   fprintf (stderr, "window_solve: end\n");
 #endif
@@ -681,6 +1055,18 @@ window_activate (GtkApplication * application)
   gtk_box_append (box, GTK_WIDGET (button_new));
   g_signal_connect (button_new, "clicked", G_CALLBACK (window_new_game), NULL);
 
+  // Open tool
+  button_open = (GtkButton *) button_new_from_icon_name ("document-open");
+  gtk_widget_set_tooltip_text (GTK_WIDGET (button_open), _("Open a game"));
+  gtk_box_append (box, GTK_WIDGET (button_open));
+  g_signal_connect (button_open, "clicked", G_CALLBACK (window_open), NULL);
+
+  // Save tool
+  button_save = (GtkButton *) button_new_from_icon_name ("document-save");
+  gtk_widget_set_tooltip_text (GTK_WIDGET (button_save), _("Save the game"));
+  gtk_box_append (box, GTK_WIDGET (button_save));
+  g_signal_connect (button_save, "clicked", G_CALLBACK (window_save), NULL);
+
   // Options tool
   button_options = (GtkButton *)
     button_new_from_icon_name ("preferences-desktop");
@@ -33,6 +33,7 @@ OF SUCH DAMAGE.
  * \author Javier Burguete Tolosa.
  * \copyright Copyright 2016-2021, Javier Burguete Tolosa.
  */
+#include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <libintl.h>
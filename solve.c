@@ -0,0 +1,369 @@
+/*
+LightsOff:
+A clone of the Tim Horton's LightsOff program written in C, adding variable
+board sizes, undo and clear movements and a solver.
+
+Copyright 2016-2021, Javier Burguete Tolosa.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+/**
+ * \file solve.c
+ * \brief Source file of the lights off headless batch solver.
+ * \author Javier Burguete Tolosa.
+ * \copyright Copyright 2016-2021, Javier Burguete Tolosa.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include <glib.h>
+#include "config.h"
+#include "game.h"
+
+///> Size of the input and output buffers.
+#define BUFFER_SIZE (1 << 16)
+///> Maximum length of a line.
+#define LINE_SIZE (N_MAX_SQUARES / 4 + 16)
+///> Number of boards solved at once.
+#define BLOCK_SIZE (1 << 16)
+
+/**
+ * Function to read a packed board codified as a hexadecimal bits chain.
+ *
+ * \return 1 on succes, 0 on error.
+ */
+static int
+board_read (const Solver * solver,      ///< solver data.
+            uint64_t * board,   ///< packed board.
+            const char *line)   ///< line with the hexadecimal chain.
+{
+  const char *c;
+  unsigned int i, d;
+  for (i = 0; i < solver->nwords; ++i)
+    board[i] = 0L;
+  for (c = line; *c && *c != '\n' && *c != '\r'; ++c);
+  if (c == line)
+    return 0;
+  for (i = 0; c-- != line; i += 4)
+    {
+      if (*c >= '0' && *c <= '9')
+        d = *c - '0';
+      else if (*c >= 'a' && *c <= 'f')
+        d = *c - 'a' + 10;
+      else if (*c >= 'A' && *c <= 'F')
+        d = *c - 'A' + 10;
+      else
+        return 0;
+      if (!d)
+        continue;
+      if (i + 32 - __builtin_clz (d) > solver->nsquares)
+        return 0;
+      board[i / N_WORD_SQUARES] |= ((uint64_t) d) << (i % N_WORD_SQUARES);
+    }
+  return 1;
+}
+
+/**
+ * Function to write an optimal solution enumerated by solver_enumerate.
+ *
+ * \return 1 to continue the enumeration.
+ */
+static int
+solution_write (const Board * solution, ///< board codifying the movements.
+                unsigned int nmovements __attribute__ ((unused)),
+                ///< number of movements.
+                void *data)     ///< solver data.
+{
+  const Solver *solver = (const Solver *) data;
+  putchar (' ');
+  board_write (stdout, solution->word, solver->nwords);
+  return 1;
+}
+
+/**
+ * Function to write the instrumentation counters of a solve as a JSON object.
+ */
+static void
+stats_write (FILE * file,       ///< output file.
+             const SolverStats * stats, ///< instrumentation counters.
+             unsigned long int nline,   ///< line of the board (0 on totals).
+             int nmovements)    ///< number of movements.
+{
+  if (nline)
+    fprintf (file, "{\"line\":%lu,\"movements\":%d,", nline, nmovements);
+  else
+    fputc ('{', file);
+  fprintf (file, "\"nodes\":%" PRIu64 ",\"chases\":%" PRIu64
+           ",\"improvements\":%" PRIu64 ",\"time\":%" PRIu64 "}",
+           stats->nodes, stats->chases, stats->improvements, stats->time);
+}
+
+/**
+ * Function to solve a block of boards writing the solutions and the
+ * instrumentation counters.
+ */
+static void
+solve_block (const Solver * solver,     ///< solver data.
+             const SolverTable * table,
+             ///< optimal solutions table (NULL to search the solutions).
+             const uint64_t * boards,   ///< array of packed boards.
+             unsigned int n,    ///< number of boards.
+             int *results,      ///< array of numbers of movements.
+             uint64_t * solutions,      ///< array of packed solutions.
+             SolverStats * stats,
+             ///< array of instrumentation counters (NULL to not save them).
+             SolverStats * total,       ///< total instrumentation counters.
+             FILE * file,       ///< instrumentation counters file.
+             unsigned long int nline,   ///< line of the first board.
+             unsigned int all,
+             ///< 1 to write every optimal solution, 0 to write only one.
+             unsigned int nthreads)     ///< number of threads.
+{
+  Board board;
+  unsigned int i, j;
+  if (table)
+    {
+      // Looking for the solutions in the table
+      for (i = 0; i < n; ++i)
+        results[i] = solver_table_solve (table, solver, boards[i],
+                                         solutions + i);
+      if (stats)
+        memset (stats, 0, n * sizeof (SolverStats));
+    }
+  else
+    play_batch (solver, boards, n, results, solutions, stats, nthreads);
+  for (i = 0; stats && i < n; ++i)
+    {
+      // Saving the instrumentation counters
+      fputs (nline + i > 1 ? ",\n" : "\n", file);
+      stats_write (file, stats + i, nline + i, results[i]);
+      total->nodes += stats[i].nodes;
+      total->chases += stats[i].chases;
+      total->improvements += stats[i].improvements;
+      total->time += stats[i].time;
+    }
+  for (i = 0; i < n; ++i)
+    {
+      if (results[i] < 0)
+        {
+          fputs ("-1\n", stdout);
+          continue;
+        }
+      printf ("%d", results[i]);
+      if (all)
+        for (j = 0; j < solver->nwords; ++j)
+          board.word[j] = boards[i * solver->nwords + j];
+
+      // Enumerating every optimal solution, or writing one if not wanted or
+      // if the null space is too large to enumerate them
+      if (!all || solver_enumerate (solver, &board, -1, solution_write,
+                                    (void *) solver) < 0)
+        {
+          putchar (' ');
+          board_write (stdout, solutions + i * solver->nwords,
+                       solver->nwords);
+        }
+      putchar ('\n');
+    }
+}
+
+/**
+ * Main function.
+ *
+ * \return 0 on succes, error code on error.
+ */
+int
+main (int argn,                 ///< arguments number.
+      char **argc)              ///< array of argument chains.
+{
+  char line[LINE_SIZE];
+  SolverStats total;
+  SolverTable table;
+  GMappedFile *mapped;
+  const SolverTable *ptable;
+  const Solver *solver;
+  Solver *data;
+  SolverStats *stats;
+  FILE *input, *file;
+  const char *name, *directory;
+  uint64_t *boards, *solutions;
+  int *results;
+  unsigned long int nline;
+  size_t length;
+  unsigned int i, nthreads, nrows, ncolumns, lookup, all;
+  int c, toolong, stencil;
+
+  // Reading the command line
+  nthreads = lookup = all = 0;
+  stencil = SOLVER_STENCIL_PLUS;
+  name = directory = NULL;
+  for (; argn > 2; argn -= 2, argc += 2)
+    if (!strcmp (argc[1], "-t"))
+      nthreads = atoi (argc[2]);
+    else if (!strcmp (argc[1], "-s"))
+      name = argc[2];
+    else if (!strcmp (argc[1], "-c"))
+      directory = argc[2];
+    else if (!strcmp (argc[1], "-n"))
+      stencil = solver_stencil (argc[2]);
+    else if (!strcmp (argc[1], "-l"))
+      {
+        // Option without argument
+        lookup = 1;
+        ++argn;
+        --argc;
+      }
+    else if (!strcmp (argc[1], "-a"))
+      {
+        // Option without argument
+        all = 1;
+        ++argn;
+        --argc;
+      }
+    else
+      break;
+  if (argn < 3 || argn > 4)
+    {
+      fprintf (stderr, "Usage: lightsoff-solve [-t threads] [-s stats_file] "
+               "[-c cache_directory] [-l] [-a] [-n neighbourhood] rows "
+               "columns [input_file]\n");
+      return 1;
+    }
+  if (stencil < 0)
+    {
+      fprintf (stderr, "lightsoff-solve: bad neighbourhood (plus, x, square "
+               "or knight, optionally followed by -torus)\n");
+      return 1;
+    }
+  if (name && !STATS)
+    {
+      fprintf (stderr, "lightsoff-solve: built without instrumentation "
+               "counters (configure --with-stats)\n");
+      return 1;
+    }
+  nrows = atoi (argc[1]);
+  ncolumns = atoi (argc[2]);
+  if (nrows < 2 || nrows > N_MAX_ROWS || ncolumns < 2
+      || ncolumns > N_MAX_COLUMNS)
+    {
+      fprintf (stderr, "lightsoff-solve: bad board size (2x2 to %ux%u)\n",
+               N_MAX_ROWS, N_MAX_COLUMNS);
+      return 1;
+    }
+  if (argn == 4)
+    {
+      input = fopen (argc[3], "r");
+      if (!input)
+        {
+          fprintf (stderr, "lightsoff-solve: unable to open %s\n", argc[3]);
+          return 1;
+        }
+    }
+  else
+    input = stdin;
+  setvbuf (input, NULL, _IOFBF, BUFFER_SIZE);
+  setvbuf (stdout, NULL, _IOFBF, BUFFER_SIZE);
+  file = NULL;
+  stats = NULL;
+  if (name)
+    {
+      file = fopen (name, "w");
+      if (!file)
+        {
+          fprintf (stderr, "lightsoff-solve: unable to open %s\n", name);
+          return 1;
+        }
+      setvbuf (file, NULL, _IOFBF, BUFFER_SIZE);
+      stats = (SolverStats *) g_malloc (BLOCK_SIZE * sizeof (SolverStats));
+      memset (&total, 0, sizeof (SolverStats));
+      fprintf (file, "{\"rows\":%u,\"columns\":%u,\"solves\":[", nrows,
+               ncolumns);
+    }
+
+  // Opening the solver data from the cache or generating them
+  if (directory)
+    solver = solver_open (directory, nrows, ncolumns, stencil, &mapped);
+  else
+    {
+      mapped = NULL;
+      solver = data = (Solver *) g_malloc (sizeof (Solver));
+      solver_init_stencil (data, nrows, ncolumns, stencil);
+    }
+
+  // Opening the optimal solutions table, generating it if it does not exist
+  ptable = NULL;
+  if (lookup && solver_table_open (&table, solver, directory, 1))
+    ptable = &table;
+
+  // Solving the boards by blocks
+  boards = (uint64_t *)
+    g_malloc (2 * BLOCK_SIZE * solver->nwords * sizeof (uint64_t));
+  solutions = boards + BLOCK_SIZE * solver->nwords;
+  results = (int *) g_malloc (BLOCK_SIZE * sizeof (int));
+  for (i = 0, nline = 1; fgets (line, LINE_SIZE, input); ++nline)
+    {
+      // Skipping the rest of a line too long for the buffer (a bad board)
+      length = strlen (line);
+      toolong = length && line[length - 1] != '\n' && !feof (input);
+      if (toolong)
+        while ((c = fgetc (input)) != EOF && c != '\n');
+      if (toolong || !board_read (solver, boards + i * solver->nwords, line))
+        {
+          solve_block (solver, ptable, boards, i, results, solutions, stats,
+                       &total, file, nline - i, all, nthreads);
+          fflush (stdout);
+          fprintf (stderr, "lightsoff-solve: bad board in line %lu\n", nline);
+          if (file)
+            fclose (file);
+          return 2;
+        }
+      if (++i == BLOCK_SIZE)
+        {
+          solve_block (solver, ptable, boards, i, results, solutions, stats,
+                       &total, file, nline + 1 - i, all, nthreads);
+          i = 0;
+        }
+    }
+  solve_block (solver, ptable, boards, i, results, solutions, stats, &total,
+               file, nline - i, all, nthreads);
+
+  // Closing
+  if (file)
+    {
+      fputs ("\n],\"total\":", file);
+      stats_write (file, &total, 0, 0);
+      fputs ("}\n", file);
+      fclose (file);
+      g_free (stats);
+    }
+  g_free (results);
+  g_free (boards);
+  if (ptable)
+    solver_table_close (&table);
+  solver_close (solver, mapped);
+  if (input != stdin)
+    fclose (input);
+  return 0;
+}